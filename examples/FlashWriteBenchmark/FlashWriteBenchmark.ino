@@ -0,0 +1,65 @@
+// Compares Print::print(F()) with NextionFlash::write() for PROGMEM strings.
+// No display is needed: output goes to a Print sink that discards bytes, so the
+// figures measure the library side of the send path only (flash reads and
+// write() call overhead), not the UART itself.
+// Results are printed to Serial in bytes/sec.
+
+#include <Arduino.h>
+#include <NextionControl.h>
+
+// Discards everything written but counts the bytes and write() calls
+class NullPrint : public Print {
+public:
+  size_t write(uint8_t) override {
+    bytes++;
+    calls++;
+    return 1;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    (void)buffer;
+    bytes += size;
+    calls++;
+    return size;
+  }
+
+  unsigned long bytes = 0;
+  unsigned long calls = 0;
+};
+
+const unsigned int Iterations = 2000;
+
+void report(const __FlashStringHelper* name, const NullPrint& sink, unsigned long elapsedUs) {
+  Serial.print(name);
+  Serial.print(F(": "));
+  Serial.print(sink.bytes);
+  Serial.print(F(" bytes, "));
+  Serial.print(sink.calls);
+  Serial.print(F(" write() calls, "));
+  Serial.print(elapsedUs);
+  Serial.print(F(" us, "));
+  Serial.print(elapsedUs ? (unsigned long)((unsigned long long)sink.bytes * 1000000ULL / elapsedUs) : 0UL);
+  Serial.println(F(" bytes/sec"));
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(50);
+
+  NullPrint printSink;
+  unsigned long start = micros();
+  for (unsigned int i = 0; i < Iterations; i++) {
+    printSink.print(F("tStatusLine.txt=\"System ready - all relays nominal\""));
+  }
+  report(F("print(F())          "), printSink, micros() - start);
+
+  NullPrint flashSink;
+  start = micros();
+  for (unsigned int i = 0; i < Iterations; i++) {
+    NextionFlash::write(&flashSink, F("tStatusLine.txt=\"System ready - all relays nominal\""));
+  }
+  report(F("NextionFlash::write "), flashSink, micros() - start);
+}
+
+void loop() {
+}
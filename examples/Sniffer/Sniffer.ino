@@ -0,0 +1,39 @@
+// Passive sniffer for the link between a host and a Nextion display.
+// Hardware (e.g. ESP32): connect the host's TX line to Serial1 RX and the
+// display's TX line to Serial2 RX, plus GND. Leave both TX pins unconnected;
+// the sniffer never transmits.
+// Decoded frames are printed to Serial: '>' host to display, '<' display to host.
+
+#include <Arduino.h>
+#include <NextionSniffer.h>
+
+const unsigned long LinkBaud = 921600;
+
+void onFrame(const NextionSnifferRecord& record, const uint8_t* frame, size_t length) {
+  Serial.print(record.time);
+  Serial.print(record.direction == NextionSnifferRecord::ToDisplay ? F(" > ") : F(" < "));
+
+  if (record.direction == NextionSnifferRecord::ToDisplay) {
+    // Commands are text
+    Serial.write(frame, length);
+  } else {
+    Serial.print(F("0x"));
+    Serial.print(record.type, HEX);
+    Serial.print(F(" value="));
+    Serial.print(record.value);
+  }
+
+  Serial.println();
+}
+
+NextionSniffer sniffer(&Serial1, &Serial2, onFrame);
+
+void setup() {
+  Serial.begin(115200);
+  Serial1.begin(LinkBaud);
+  Serial2.begin(LinkBaud);
+}
+
+void loop() {
+  sniffer.update();
+}
@@ -0,0 +1,102 @@
+// Compares NextionTextEncoder::write() with a naive String-per-character
+// conversion of UTF-8 text to Windows-1252.
+// No display is needed: output goes to a Print sink that discards bytes, so the
+// figures measure the library side of the send path only (decoding, mapping,
+// escaping and write() call overhead), not the UART itself.
+// Results are printed to Serial in texts/sec; both methods must produce the
+// same number of bytes.
+
+#include <Arduino.h>
+#include <NextionControl.h>
+
+// Discards everything written but counts the bytes and write() calls
+class NullPrint : public Print {
+public:
+  size_t write(uint8_t) override {
+    bytes++;
+    calls++;
+    return 1;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    (void)buffer;
+    bytes += size;
+    calls++;
+    return size;
+  }
+
+  unsigned long bytes = 0;
+  unsigned long calls = 0;
+};
+
+const unsigned int Iterations = 2000;
+
+// Accents, a euro sign, typographic quotes and a quote that must be escaped
+const char Sample[] = "Caf\xC3\xA9 \xE2\x82\xAC" "4,50 \xE2\x80\x9Crenouvel\xC3\xA9\xE2\x80\x9D \"ok\" \xE2\x80\x93 na\xC3\xAFve";
+
+// What a sketch would write without the encoder: one String per character
+void naiveSend(Print& port, const char* text) {
+  String converted;
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(text);
+
+  while (*p) {
+    uint32_t codepoint = *p++;
+
+    if (codepoint >= 0xE0 && p[0] && p[1]) {
+      codepoint = ((codepoint & 0x0F) << 12) | ((uint32_t)(p[0] & 0x3F) << 6) | (p[1] & 0x3F);
+      p += 2;
+    } else if (codepoint >= 0xC0 && p[0]) {
+      codepoint = ((codepoint & 0x1F) << 6) | (p[0] & 0x3F);
+      p++;
+    }
+
+    char mapped = (char)NextionTextEncoder::map(&CodePageWindows1252, codepoint);
+
+    if (mapped == '"' || mapped == '\\') {
+      converted += String('\\');
+    }
+
+    converted += String(mapped);
+  }
+
+  port.print(converted);
+}
+
+void report(const __FlashStringHelper* name, const NullPrint& sink, unsigned long elapsedUs) {
+  Serial.print(name);
+  Serial.print(F(": "));
+  Serial.print(sink.bytes);
+  Serial.print(F(" bytes, "));
+  Serial.print(sink.calls);
+  Serial.print(F(" write() calls, "));
+  Serial.print(elapsedUs);
+  Serial.print(F(" us, "));
+  Serial.print(elapsedUs ? (unsigned long)((unsigned long long)Iterations * 1000000ULL / elapsedUs) : 0UL);
+  Serial.println(F(" texts/sec"));
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(50);
+
+  NullPrint naiveSink;
+  unsigned long start = micros();
+  for (unsigned int i = 0; i < Iterations; i++) {
+    naiveSend(naiveSink, Sample);
+  }
+  report(F("String per character   "), naiveSink, micros() - start);
+
+  NullPrint encoderSink;
+  start = micros();
+  for (unsigned int i = 0; i < Iterations; i++) {
+    NextionTextEncoder::write(&encoderSink, Sample, sizeof(Sample) - 1, &CodePageWindows1252);
+  }
+  report(F("NextionTextEncoder     "), encoderSink, micros() - start);
+
+  if (naiveSink.bytes != encoderSink.bytes) {
+    Serial.println(F("Output lengths differ"));
+  }
+}
+
+void loop() {
+}
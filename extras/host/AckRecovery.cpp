@@ -0,0 +1,189 @@
+// Host check: acknowledgement tracking survives a display restart and a lost link.
+//
+// A simulated panel answers commands according to its bkcmd level, like a real
+// one: with bkcmd=3 every command gets 0x01, with its HMI default (bkcmd=2)
+// successful commands get no reply. The panel is rebooted twice: once
+// announcing the restart (00 00 00, then 0x88), and once while unreachable, so
+// the controller only sees the link come back. After each recovery the
+// controller must switch the panel back to bkcmd=3; otherwise every tracked
+// command times out and is reported as a failure. The program exits non-zero
+// if a command fails after either recovery.
+
+#include <Arduino.h>
+#include <NextionControl.h>
+#include <NextionCommandTracker.h>
+#include <string.h>
+#include <unistd.h>
+
+// Panel behind an in-memory port: parses commands as they are written and queues its replies
+class SimulatedPanel : public Stream {
+public:
+    int available() override { return static_cast<int>(_length - _position); }
+    int read() override { return _position < _length ? _rx[_position++] : -1; }
+    int peek() override { return _position < _length ? _rx[_position] : -1; }
+
+    size_t write(uint8_t value) override
+    {
+        if (value != 0xFF)
+        {
+            _terminators = 0;
+
+            if (_used < sizeof(_command) - 1)
+                _command[_used++] = static_cast<char>(value);
+        }
+        else if (++_terminators == 3)
+        {
+            _command[_used] = '\0';
+            execute();
+            _used = 0;
+            _terminators = 0;
+        }
+
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override
+    {
+        for (size_t i = 0; i < size; i++)
+            write(buffer[i]);
+
+        return size;
+    }
+
+    using Print::write;
+
+    /// Restart: the panel forgets bkcmd=3 and, if reachable, announces itself
+    void reboot(bool announce)
+    {
+        static const uint8_t startup[] = { 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF };
+        static const uint8_t ready[] = { 0x88, 0xFF, 0xFF, 0xFF };
+
+        bkcmd = 2;
+
+        if (announce)
+        {
+            reply(startup, sizeof(startup));
+            reply(ready, sizeof(ready));
+        }
+    }
+
+    bool reachable = true;
+    uint8_t bkcmd = 2;
+
+private:
+    void execute()
+    {
+        static const uint8_t success[] = { 0x01, 0xFF, 0xFF, 0xFF };
+
+        if (!reachable)
+            return;
+
+        if (strncmp(_command, "bkcmd=", 6) == 0)
+            bkcmd = static_cast<uint8_t>(atoi(_command + 6));
+
+        if (strcmp(_command, "sendme") == 0)
+        {
+            const uint8_t page[] = { 0x66, 0x00, 0xFF, 0xFF, 0xFF };
+            reply(page, sizeof(page));
+        }
+        else if (bkcmd == 1 || bkcmd == 3)
+        {
+            reply(success, sizeof(success));
+        }
+    }
+
+    void reply(const uint8_t* frame, size_t length)
+    {
+        if (_position == _length)
+            _position = _length = 0;
+
+        for (size_t i = 0; i < length && _length < sizeof(_rx); i++)
+            _rx[_length++] = frame[i];
+    }
+
+    uint8_t _rx[512];
+    size_t _length = 0;
+    size_t _position = 0;
+    char _command[64];
+    size_t _used = 0;
+    uint8_t _terminators = 0;
+};
+
+class StatusPage : public BaseDisplayPage {
+public:
+    explicit StatusPage(Stream* port) : BaseDisplayPage(port), counter(this, F("n0")) {}
+
+    void begin() override {}
+
+    void refresh(unsigned long now) override { counter.set(static_cast<int32_t>(now & 0x7FFF)); }
+
+    void handleCommandFailure(const NextionCommandRecord&, uint8_t responseCode) override
+    {
+        if (responseCode == CommandTimeoutCode)
+            timeouts++;
+        else
+            failures++;
+    }
+
+    NumberWidget counter;
+    unsigned long timeouts = 0;
+    unsigned long failures = 0;
+
+protected:
+    uint8_t getPageId() const override { return 0; }
+};
+
+static void run(NextionControl& nextion, unsigned long duration)
+{
+    unsigned long start = millis();
+
+    while (millis() - start < duration)
+    {
+        nextion.update(millis());
+        usleep(1000);
+    }
+}
+
+// Let recovery and the ack timeouts of anything sent before it play out, then count failures
+static bool settled(const char* phase, NextionControl& nextion, StatusPage& page, SimulatedPanel& panel)
+{
+    run(nextion, 2 * CommandAckTimeout * (CommandMaxRetries + 1));
+    page.timeouts = page.failures = 0;
+    run(nextion, 3000);
+
+    printf("%s: bkcmd=%u, %lu timeouts, %lu other failures, link %s\n", phase, panel.bkcmd, page.timeouts,
+        page.failures, nextion.getLinkState() == LinkConnected ? "connected" : "not connected");
+
+    return panel.bkcmd == 3 && page.timeouts == 0 && page.failures == 0 && nextion.getLinkState() == LinkConnected;
+}
+
+int main()
+{
+    const unsigned long heartbeat = 200;
+
+    SimulatedPanel panel;
+    NextionCommandTracker tracker(&panel);
+    StatusPage page(&panel);
+    BaseDisplayPage* pages[] = { &page };
+    NextionControl nextion(&panel, pages, 1);
+
+    nextion.begin();
+    nextion.setAckTracking(&tracker);
+    nextion.setHeartbeat(heartbeat);
+
+    bool ok = settled("steady", nextion, page, panel);
+
+    // Restart announced with 00 00 00 and 0x88
+    panel.reboot(true);
+    ok = settled("after restart", nextion, page, panel) && ok;
+
+    // Restart while unreachable: only the lost link and its return are seen
+    panel.reachable = false;
+    run(nextion, heartbeat * (LinkMaxMisses + 2) + LinkReplyTimeout);
+    bool lost = nextion.getLinkState() == LinkLost;
+    panel.reboot(false);
+    panel.reachable = true;
+    ok = settled("after lost link", nextion, page, panel) && ok && lost;
+
+    return ok ? 0 : 1;
+}
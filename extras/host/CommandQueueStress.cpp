@@ -0,0 +1,199 @@
+// Host check: NextionCommandQueue under concurrent producers.
+//
+// Several std::thread producers post numbered commands while the main thread
+// drains the queue through NextionControl::update() and another thread polls
+// size(). The port checks every command as it is written: each producer's
+// numbers must arrive complete, once and in order. The program exits non-zero
+// on a lost, duplicated, reordered or torn command, or if size() ever reports
+// more than the capacity.
+//
+// Build with -pthread; run under -fsanitize=thread to check the memory ordering.
+
+#include <Arduino.h>
+#include <NextionControl.h>
+#include <NextionCommandQueue.h>
+#include <atomic>
+#include <thread>
+
+#ifndef NEXTION_COMMAND_QUEUE
+#error "NextionCommandQueue needs <atomic>"
+#endif
+
+const int Producers = 4;
+const int32_t CommandsPerProducer = 200000;
+
+// A queue that loses a slot stalls instead of delivering; give up after this long (ms)
+const unsigned long TimeLimit = 60000;
+
+// Checks each written command against the number expected from its producer
+class CheckingPort : public Stream {
+public:
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+    size_t write(uint8_t value) override
+    {
+        if (value != 0xFF)
+        {
+            if (_terminators > 0)
+                finish();
+
+            if (_length < sizeof(_command) - 1)
+                _command[_length++] = static_cast<char>(value);
+            else
+                _overlong = true;
+        }
+        else if (++_terminators == 3)
+        {
+            finish();
+        }
+
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override
+    {
+        for (size_t i = 0; i < size; i++)
+            write(buffer[i]);
+
+        return size;
+    }
+
+    using Print::write;
+
+    bool complete() const
+    {
+        for (int i = 0; i < Producers; i++)
+        {
+            if (_next[i] != CommandsPerProducer)
+                return false;
+        }
+
+        return true;
+    }
+
+    unsigned long commands = 0;
+    unsigned long errors = 0;
+
+private:
+    void finish()
+    {
+        int producer;
+        long value;
+
+        _command[_length] = '\0';
+
+        // The controller's own commands (page requests, bkcmd) are not checked
+        if (_terminators == 3 && !_overlong && sscanf(_command, "n%d.val=%ld", &producer, &value) != 2)
+        {
+            _length = 0;
+            _terminators = 0;
+            return;
+        }
+
+        commands++;
+
+        if (_terminators != 3 || _overlong || producer < 0 || producer >= Producers || value != _next[producer])
+        {
+            if (errors++ < 5)
+                printf("unexpected command '%s'\n", _command);
+        }
+        else
+        {
+            _next[producer]++;
+        }
+
+        _length = 0;
+        _terminators = 0;
+        _overlong = false;
+    }
+
+    char _command[32];
+    size_t _length = 0;
+    uint8_t _terminators = 0;
+    bool _overlong = false;
+    long _next[Producers] = {};
+};
+
+class IdlePage : public BaseDisplayPage {
+public:
+    explicit IdlePage(Stream* port) : BaseDisplayPage(port) {}
+
+    void begin() override {}
+    void refresh(unsigned long) override {}
+
+protected:
+    uint8_t getPageId() const override { return 0; }
+};
+
+static NextionCommandQueue<64, 32> queue;
+
+int main()
+{
+    static const char* const prefixes[Producers] = { "n0.val=", "n1.val=", "n2.val=", "n3.val=" };
+
+    CheckingPort port;
+    IdlePage page(&port);
+    BaseDisplayPage* pages[] = { &page };
+    NextionControl nextion(&port, pages, 1);
+
+    nextion.begin();
+    nextion.setCommandQueue(&queue);
+
+    std::atomic<int> finished(0);
+    std::atomic<bool> oversized(false);
+    std::thread producers[Producers];
+
+    for (int p = 0; p < Producers; p++)
+    {
+        producers[p] = std::thread([&finished, p]() {
+            // The host core reads F() strings from RAM like any other
+            const __FlashStringHelper* prefix = reinterpret_cast<const __FlashStringHelper*>(prefixes[p]);
+
+            for (int32_t i = 0; i < CommandsPerProducer;)
+            {
+                if (queue.postValue(prefix, i))
+                    i++;
+                else
+                    std::this_thread::yield();
+            }
+
+            finished++;
+        });
+    }
+
+    std::thread monitor([&finished, &oversized]() {
+        while (finished.load() < Producers)
+        {
+            if (queue.size() > queue.capacity())
+                oversized = true;
+
+            std::this_thread::yield();
+        }
+    });
+
+    unsigned long start = millis();
+
+    while (finished.load() < Producers || queue.size() > 0)
+    {
+        if (millis() - start > TimeLimit)
+        {
+            printf("stalled after %lu commands\n", port.commands);
+            return 1;
+        }
+
+        nextion.update(millis());
+        std::this_thread::yield();
+    }
+
+    for (int p = 0; p < Producers; p++)
+        producers[p].join();
+
+    monitor.join();
+
+    printf("%lu commands in %lu ms, %u posted, %u rejected while full, %lu errors\n", port.commands,
+        millis() - start, queue.postedCount(), queue.rejectedCount(), port.errors);
+
+    return port.errors == 0 && port.complete() && !oversized ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+// Host benchmark: CPU cost per display of NextionEventLoop.
+//
+// 64 controllers talk to simulated displays over pseudo-terminal pairs. A
+// simulator thread answers heartbeats with page reports and sends one touch
+// every 20 ms, spread over the displays; the last eight displays stay silent
+// so their links are lost during the run. The CPU time of the thread driving
+// the controllers is reported per display, for NextionEventLoop or, with the
+// "poll" argument, for a loop updating every controller each millisecond.
+//
+//     ./EventLoopBenchmark [poll] [seconds]
+//
+// The program exits non-zero if a touch is lost or a silent link is not
+// declared lost.
+
+#include <Arduino.h>
+#include <NextionControl.h>
+#include <NextionEventLoop.h>
+#include <atomic>
+#include <pty.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <thread>
+
+#ifndef NEXTION_EVENT_LOOP
+#error "NextionEventLoop needs Linux (epoll, eventfd)"
+#endif
+
+const int Displays = EventLoopMaxDisplays;
+const int SilentDisplays = 8;
+const unsigned long Heartbeat = 1000;
+const unsigned long TouchInterval = 20;
+
+class CounterPage : public BaseDisplayPage {
+public:
+    explicit CounterPage(Stream* port) : BaseDisplayPage(port), counter(this, F("n0")) {}
+
+    void begin() override {}
+
+    void refresh(unsigned long) override { counter.set(_value++); }
+
+    void handleTouch(uint8_t, uint8_t) override { touches++; }
+
+    NumberWidget counter;
+    unsigned long touches = 0;
+
+protected:
+    uint8_t getPageId() const override { return 0; }
+
+private:
+    int32_t _value = 0;
+};
+
+struct Display {
+    NextionPosixSerial port;
+    CounterPage* page;
+    BaseDisplayPage* pages[1];
+    NextionControl* control;
+    int simulator;
+    size_t matched;
+};
+
+static Display displays[Displays];
+
+static double threadSeconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Answers "sendme" heartbeats (split reads included) and injects touches
+static void simulate(std::atomic<bool>& running, std::atomic<unsigned long>& touchesSent)
+{
+    static const char heartbeat[] = "sendme\xFF\xFF\xFF";
+    static const uint8_t pageReport[] = { 0x66, 0x00, 0xFF, 0xFF, 0xFF };
+    static const uint8_t touch[] = { 0x65, 0x00, 0x03, 0x01, 0xFF, 0xFF, 0xFF };
+
+    uint8_t buffer[4096];
+    unsigned long nextTouch = millis();
+    int target = 0;
+
+    while (running.load())
+    {
+        for (int i = 0; i < Displays; i++)
+        {
+            Display& display = displays[i];
+            ssize_t count;
+
+            while ((count = ::read(display.simulator, buffer, sizeof(buffer))) > 0)
+            {
+                for (ssize_t j = 0; j < count; j++)
+                {
+                    display.matched = buffer[j] == static_cast<uint8_t>(heartbeat[display.matched]) ? display.matched + 1 :
+                        (buffer[j] == static_cast<uint8_t>(heartbeat[0]) ? 1 : 0);
+
+                    if (display.matched < sizeof(heartbeat) - 1)
+                        continue;
+
+                    display.matched = 0;
+                    if (i < Displays - SilentDisplays && ::write(display.simulator, pageReport, sizeof(pageReport)) < 0)
+                        perror("write");
+                }
+            }
+        }
+
+        if (static_cast<long>(millis() - nextTouch) >= 0)
+        {
+            nextTouch += TouchInterval;
+
+            if (::write(displays[target].simulator, touch, sizeof(touch)) == static_cast<ssize_t>(sizeof(touch)))
+                touchesSent++;
+
+            target = (target + 1) % (Displays - SilentDisplays);
+        }
+
+        usleep(1000);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool polling = argc > 1 && strcmp(argv[1], "poll") == 0;
+    int seconds = argc > (polling ? 2 : 1) ? atoi(argv[polling ? 2 : 1]) : 10;
+
+    if (seconds <= 0)
+        seconds = 10;
+
+    for (int i = 0; i < Displays; i++)
+    {
+        Display& display = displays[i];
+        int peer;
+        char name[64];
+
+        if (openpty(&display.simulator, &peer, name, nullptr, nullptr) != 0)
+        {
+            perror("openpty");
+            return 1;
+        }
+
+        // The controller side goes through open() and termios like a real tty
+        if (!display.port.open(name, 115200))
+        {
+            printf("%s: %s\n", name, strerror(display.port.error()));
+            return 1;
+        }
+
+        ::close(peer);
+        fcntl(display.simulator, F_SETFL, fcntl(display.simulator, F_GETFL) | O_NONBLOCK);
+
+        display.page = new CounterPage(&display.port);
+        display.pages[0] = display.page;
+        display.control = new NextionControl(&display.port, display.pages, 1);
+        display.control->setHeartbeat(Heartbeat);
+        display.matched = 0;
+    }
+
+    std::atomic<bool> running(true);
+    std::atomic<unsigned long> touchesSent(0);
+    std::thread simulator(simulate, std::ref(running), std::ref(touchesSent));
+
+    NextionEventLoop loop;
+
+    for (int i = 0; i < Displays; i++)
+    {
+        displays[i].control->begin();
+
+        if (!loop.add(displays[i].control, &displays[i].port))
+        {
+            printf("cannot watch display %d\n", i);
+            return 1;
+        }
+    }
+
+    double startCpu = threadSeconds();
+    unsigned long end = millis() + static_cast<unsigned long>(seconds) * 1000;
+    unsigned long passes = 0;
+
+    while (static_cast<long>(millis() - end) < 0)
+    {
+        if (polling)
+        {
+            unsigned long now = millis();
+
+            for (int i = 0; i < Displays; i++)
+                displays[i].control->update(now);
+
+            usleep(1000);
+        }
+        else
+        {
+            loop.runOnce(100);
+        }
+
+        passes++;
+    }
+
+    double cpu = threadSeconds() - startCpu;
+
+    // Let the last touches arrive before counting
+    running = false;
+    simulator.join();
+
+    for (int pass = 0; pass < 10; pass++)
+        loop.runOnce(10);
+
+    unsigned long touches = 0;
+    int lost = 0;
+
+    for (int i = 0; i < Displays; i++)
+    {
+        touches += displays[i].page->touches;
+
+        if (displays[i].control->getLinkState() == LinkLost)
+            lost++;
+    }
+
+    printf("%s: %d displays (%d silent), %d s\n", polling ? "polling every 1 ms" : "NextionEventLoop", Displays,
+        SilentDisplays, seconds);
+    printf("  CPU %.2f ms/s in total, %.4f ms/s per display (%.4f%% of a core)\n", cpu * 1000 / seconds,
+        cpu * 1000 / seconds / Displays, cpu * 100 / seconds / Displays);
+    printf("  %lu passes, %u wake-ups, %u updates\n", passes, loop.wakeupCount(), loop.updateCount());
+    printf("  touches %lu/%lu delivered, %d links lost\n", touches, touchesSent.load(), lost);
+
+    return touches == touchesSent.load() && lost == SilentDisplays ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+// Host check: NextionControl::update() performs no heap allocation in steady state.
+//
+// A scripted display answers over an in-memory Stream while pages refresh
+// widgets, receive touches, numeric returns and page reports. After a warm-up,
+// every update() runs inside the NextionHeapGuard scope and any operator new or
+// malloc call is counted; the program exits non-zero if one occurs.
+//
+// Build with NEXTION_HEAP_GUARD defined for the whole build (see README.md).
+
+#include <Arduino.h>
+#include <NextionControl.h>
+#include <unistd.h>
+
+#ifndef NEXTION_HEAP_GUARD
+#error "Build with -DNEXTION_HEAP_GUARD for every translation unit"
+#endif
+
+NEXTION_HEAP_GUARD_INSTALL()
+
+// Fixed-size loopback port: bytes written are discarded, scripted replies are read back
+class ScriptedPort : public Stream {
+public:
+    int available() override { return static_cast<int>(_length - _position); }
+    int read() override { return _position < _length ? _rx[_position++] : -1; }
+    int peek() override { return _position < _length ? _rx[_position] : -1; }
+
+    size_t write(uint8_t) override
+    {
+        written++;
+        return 1;
+    }
+
+    size_t write(const uint8_t*, size_t size) override
+    {
+        written += size;
+        return size;
+    }
+
+    using Print::write;
+
+    void reply(const uint8_t* frame, size_t length)
+    {
+        if (_position == _length)
+            _position = _length = 0;
+
+        for (size_t i = 0; i < length && _length < sizeof(_rx); i++)
+            _rx[_length++] = frame[i];
+    }
+
+    unsigned long written = 0;
+
+private:
+    uint8_t _rx[256];
+    size_t _length = 0;
+    size_t _position = 0;
+};
+
+class StatusPage : public BaseDisplayPage {
+public:
+    explicit StatusPage(Stream* port)
+        : BaseDisplayPage(port), counter(this, F("n0")), status(this, F("t0")) {}
+
+    void begin() override {}
+
+    void refresh(unsigned long now) override
+    {
+        // The widget keeps a pointer to the text, so the buffer belongs to the page
+        snprintf(text, sizeof(text), "up %lu", (now / 1000) % 100000UL);
+
+        counter.set(static_cast<int32_t>(now & 0x7FFF));
+        status.set(text);
+        sendCommand(F("get n1.val"));
+    }
+
+    void handleTouch(uint8_t, uint8_t) override { touches++; }
+    void handleNumeric(int32_t) override { numerics++; }
+
+    NumberWidget counter;
+    TextWidget status;
+    char text[16];
+    unsigned long touches = 0;
+    unsigned long numerics = 0;
+
+protected:
+    uint8_t getPageId() const override { return 0; }
+};
+
+static uint32_t violations = 0;
+
+static void onViolation(size_t size)
+{
+    violations++;
+    printf("allocation of %u bytes inside update()\n", static_cast<unsigned>(size));
+}
+
+int main()
+{
+    static const uint8_t pageReport[] = { 0x66, 0x00, 0xFF, 0xFF, 0xFF };
+    static const uint8_t touch[] = { 0x65, 0x00, 0x03, 0x01, 0xFF, 0xFF, 0xFF };
+    static const uint8_t numeric[] = { 0x71, 0x2A, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF };
+    static const uint8_t success[] = { 0x01, 0xFF, 0xFF, 0xFF };
+
+    ScriptedPort port;
+    StatusPage page(&port);
+    BaseDisplayPage* pages[] = { &page };
+    NextionControl nextion(&port, pages, 1);
+
+    NextionHeapGuard::setViolationCallback(onViolation);
+    nextion.begin();
+
+    const unsigned long warmUp = 1500;
+    const unsigned long duration = 5000;
+    unsigned long start = millis();
+    unsigned long updates = 0;
+    bool measuring = false;
+
+    for (unsigned long now = start; now - start < warmUp + duration; now = millis())
+    {
+        if (!measuring && now - start >= warmUp)
+        {
+            NextionHeapGuard::reset();
+            violations = 0;
+            measuring = true;
+        }
+
+        // A little traffic from the display on every pass
+        switch (updates % 4)
+        {
+            case 0: port.reply(touch, sizeof(touch)); break;
+            case 1: port.reply(numeric, sizeof(numeric)); break;
+            case 2: port.reply(success, sizeof(success)); break;
+            default: port.reply(pageReport, sizeof(pageReport)); break;
+        }
+
+        nextion.update(now);
+        updates++;
+        usleep(1000);
+    }
+
+    printf("%lu updates, %lu touches, %lu numeric returns, %lu bytes sent, %u allocations inside update()\n",
+        updates, page.touches, page.numerics, port.written, static_cast<unsigned>(NextionHeapGuard::violationCount()));
+
+    return NextionHeapGuard::violationCount() == 0 && violations == 0 ? 0 : 1;
+}
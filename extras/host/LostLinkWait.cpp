@@ -0,0 +1,131 @@
+// Host check: nextDeadline() lets an event loop sleep while the link is lost.
+//
+// A display that never answers is driven into LinkLost while a widget value,
+// a background page and a queued command are still pending. update() suspends
+// that work while the link is lost, so a deadline based on it would stay in
+// the past and an event loop would spin. The program checks that every wait
+// reported after the loss is longer than zero and that a reply brings the link
+// back.
+
+#include <Arduino.h>
+#include <NextionControl.h>
+#include <NextionCommandQueue.h>
+#include <unistd.h>
+
+// Port of a display that has gone away: output is discarded, nothing is received
+class SilentPort : public Stream {
+public:
+    int available() override { return static_cast<int>(_length - _position); }
+    int read() override { return _position < _length ? _rx[_position++] : -1; }
+    int peek() override { return _position < _length ? _rx[_position] : -1; }
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t size) override { return size; }
+
+    using Print::write;
+
+    void reply(const uint8_t* frame, size_t length)
+    {
+        _position = 0;
+        _length = length < sizeof(_rx) ? length : sizeof(_rx);
+        memcpy(_rx, frame, _length);
+    }
+
+private:
+    uint8_t _rx[16];
+    size_t _length = 0;
+    size_t _position = 0;
+};
+
+class CounterPage : public BaseDisplayPage {
+public:
+    CounterPage(Stream* port, uint8_t id) : BaseDisplayPage(port), counter(this, F("n0")), _id(id) {}
+
+    void begin() override {}
+
+    void refresh(unsigned long now) override { counter.set(static_cast<int32_t>(now & 0x7FFF)); }
+
+    NumberWidget counter;
+
+protected:
+    uint8_t getPageId() const override { return _id; }
+
+private:
+    uint8_t _id;
+};
+
+int main()
+{
+    static const uint8_t pageReport[] = { 0x66, 0x00, 0xFF, 0xFF, 0xFF };
+    const unsigned long heartbeat = 200;
+
+    SilentPort port;
+    CounterPage main(&port, 0);
+    CounterPage other(&port, 1);
+    BaseDisplayPage* pages[] = { &main, &other };
+    NextionControl nextion(&port, pages, 2);
+
+    nextion.setHeartbeat(heartbeat);
+    nextion.begin();
+
+#ifdef NEXTION_COMMAND_QUEUE
+    static NextionCommandQueue<4, 16> queue;
+    nextion.setCommandQueue(&queue);
+#endif
+
+    // Wait for the link to be declared lost, sleeping as an event loop would
+    unsigned long start = millis();
+
+    while (nextion.getLinkState() != LinkLost)
+    {
+        unsigned long now = millis();
+
+        if (now - start > heartbeat * (LinkMaxMisses + 4) + LinkReplyTimeout)
+        {
+            printf("link was never declared lost\n");
+            return 1;
+        }
+
+        nextion.update(now);
+
+        long wait = static_cast<long>(nextion.nextDeadline(millis()) - millis());
+        usleep(wait > 0 ? static_cast<useconds_t>(wait) * 1000 : 1000);
+    }
+
+    // Work that update() holds back while the link is lost
+    main.counter.set(12345);
+#ifdef NEXTION_COMMAND_QUEUE
+    queue.post(F("dim=50"));
+#endif
+
+    unsigned long updates = 0;
+    unsigned long spins = 0;
+    long shortest = -1;
+    start = millis();
+
+    while (millis() - start < 3 * heartbeat)
+    {
+        unsigned long now = millis();
+        nextion.update(now);
+        updates++;
+
+        long wait = static_cast<long>(nextion.nextDeadline(now) - now);
+
+        if (wait <= 0)
+            spins++;
+
+        if (shortest < 0 || wait < shortest)
+            shortest = wait;
+
+        usleep(wait > 0 ? static_cast<useconds_t>(wait) * 1000 : 100);
+    }
+
+    // A reply ends the loss
+    port.reply(pageReport, sizeof(pageReport));
+    nextion.update(millis());
+    bool recovered = nextion.getLinkState() == LinkConnected;
+
+    printf("lost link: %lu updates in %lu ms, shortest wait %ld ms, %lu zero waits, %s\n", updates,
+        3 * heartbeat, shortest, spins, recovered ? "recovered" : "not recovered");
+
+    return spins == 0 && recovered ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+// Host check: NextionPosixSerial end to end over a pseudo-terminal pair.
+//
+// The controller opens the slave side of a pty through open() and termios, as
+// it would a real serial device; a simulated display thread serves the master
+// side. The program checks that:
+// - a burst of 50 touch frames arriving in one read is dispatched in full;
+// - a `get` query is answered and its numeric return reaches the page;
+// - 40 commands of 300 bytes sent while the kernel buffer is full are held by
+//   the port (write(), makeRoom(), sendPending()) and arrive intact and in
+//   order once the display drains the line.
+// It exits non-zero if any of these fails.
+
+#include <Arduino.h>
+#include <NextionControl.h>
+#include <NextionPosixSerial.h>
+#include <atomic>
+#include <pty.h>
+#include <string.h>
+#include <thread>
+
+#ifndef NEXTION_POSIX_SERIAL
+#error "NextionPosixSerial needs a POSIX host"
+#endif
+
+const int TouchBurst = 50;
+const int BulkCommands = 40;
+const size_t BulkLength = 300;
+
+// Bulk command i: "b" and two digits, then a pattern that depends on i and the position
+static void bulkCommand(int index, char* command)
+{
+    snprintf(command, 4, "b%02d", index);
+
+    for (size_t i = 3; i < BulkLength; i++)
+        command[i] = static_cast<char>('a' + (index + i) % 26);
+
+    command[BulkLength] = '\0';
+}
+
+// Display side of the pty: answers queries and checks bulk commands
+class SimulatedDisplay {
+public:
+    explicit SimulatedDisplay(int fd) : _fd(fd) {}
+
+    void run()
+    {
+        uint8_t buffer[512];
+
+        while (running.load())
+        {
+            if (!draining.load())
+            {
+                usleep(1000);
+                continue;
+            }
+
+            ssize_t count = ::read(_fd, buffer, sizeof(buffer));
+
+            if (count <= 0)
+            {
+                usleep(1000);
+                continue;
+            }
+
+            for (ssize_t i = 0; i < count; i++)
+                receive(buffer[i]);
+        }
+    }
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> draining{true};
+    std::atomic<int> bulkReceived{0};
+    std::atomic<int> bulkErrors{0};
+
+private:
+    void receive(uint8_t value)
+    {
+        if (value != 0xFF)
+        {
+            _terminators = 0;
+
+            if (_length < sizeof(_command) - 1)
+                _command[_length++] = static_cast<char>(value);
+
+            return;
+        }
+
+        if (++_terminators < 3)
+            return;
+
+        _command[_length] = '\0';
+        execute();
+        _length = 0;
+        _terminators = 0;
+    }
+
+    void execute()
+    {
+        static const uint8_t numeric[] = { 0x71, 0x2A, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF };
+
+        if (strncmp(_command, "get ", 4) == 0)
+        {
+            if (::write(_fd, numeric, sizeof(numeric)) < 0)
+                perror("write");
+        }
+        else if (_length > 0 && _command[0] == 'b')
+        {
+            char expected[BulkLength + 1];
+            bulkCommand(bulkReceived.load(), expected);
+
+            if (_length != BulkLength || memcmp(_command, expected, BulkLength) != 0)
+                bulkErrors++;
+
+            bulkReceived++;
+        }
+    }
+
+    int _fd;
+    char _command[BulkLength + 16];
+    size_t _length = 0;
+    uint8_t _terminators = 0;
+};
+
+class StatusPage : public BaseDisplayPage {
+public:
+    explicit StatusPage(Stream* port) : BaseDisplayPage(port) {}
+
+    void begin() override {}
+    void refresh(unsigned long) override {}
+
+    void handleTouch(uint8_t, uint8_t) override { touches++; }
+    void handleNumeric(int32_t value) override { number = value; }
+
+    int touches = 0;
+    int32_t number = 0;
+
+protected:
+    uint8_t getPageId() const override { return 0; }
+};
+
+// Run update() until `done` or `timeout` ms have passed
+template <typename Condition>
+static bool runUntil(NextionControl& nextion, Condition done, unsigned long timeout)
+{
+    unsigned long start = millis();
+
+    while (!done())
+    {
+        if (millis() - start > timeout)
+            return false;
+
+        nextion.update(millis());
+        usleep(1000);
+    }
+
+    return true;
+}
+
+int main()
+{
+    int master;
+    int slave;
+    char name[64];
+
+    if (openpty(&master, &slave, name, nullptr, nullptr) != 0)
+    {
+        perror("openpty");
+        return 1;
+    }
+
+    NextionPosixSerial port;
+
+    if (!port.open(name, 115200))
+    {
+        printf("%s: %s\n", name, strerror(port.error()));
+        return 1;
+    }
+
+    ::close(slave);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    StatusPage page(&port);
+    BaseDisplayPage* pages[] = { &page };
+    NextionControl nextion(&port, pages, 1);
+
+    SimulatedDisplay display(master);
+    std::thread simulator(&SimulatedDisplay::run, &display);
+
+    static const uint8_t pageReport[] = { 0x66, 0x00, 0xFF, 0xFF, 0xFF };
+    static const uint8_t touch[] = { 0x65, 0x00, 0x03, 0x01, 0xFF, 0xFF, 0xFF };
+
+    if (::write(master, pageReport, sizeof(pageReport)) < 0)
+        perror("write");
+
+    nextion.begin();
+    runUntil(nextion, []() { return false; }, 50);
+
+    // Burst of touches delivered in one read, and a query answered by the display
+    uint8_t burst[TouchBurst * sizeof(touch)];
+    for (int i = 0; i < TouchBurst; i++)
+        memcpy(burst + i * sizeof(touch), touch, sizeof(touch));
+
+    if (::write(master, burst, sizeof(burst)) < 0)
+        perror("write");
+
+    nextion.sendCommand(F("get n5.val"));
+    bool received = runUntil(nextion, [&page]() { return page.touches == TouchBurst && page.number == 42; }, 1000);
+
+    printf("touch burst: %d/%d dispatched; get reply: %ld\n", page.touches, TouchBurst, static_cast<long>(page.number));
+
+    // Fill the kernel buffer through a second descriptor while the display stops reading
+    display.draining = false;
+
+    // 0xFF filler: the kernel may take a partial write, and stray terminator bytes frame nothing
+    int filler = ::open(name, O_WRONLY | O_NOCTTY | O_NONBLOCK);
+    uint8_t fill[64];
+    memset(fill, 0xFF, sizeof(fill));
+    size_t filled = 0;
+    ssize_t count;
+
+    while (filler >= 0 && (count = ::write(filler, fill, sizeof(fill))) > 0)
+        filled += static_cast<size_t>(count);
+
+    bool full = filler >= 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+
+    // The display resumes reading well within SerialTimeout
+    std::thread resume([&display]() {
+        usleep(100000);
+        display.draining = true;
+    });
+
+    bool held = false;
+
+    for (int i = 0; i < BulkCommands; i++)
+    {
+        char command[BulkLength + 1];
+        bulkCommand(i, command);
+        nextion.sendCommand(command, BulkLength);
+
+        if (port.hasPendingOutput())
+            held = true;
+    }
+
+    port.flush();
+    resume.join();
+
+    bool delivered = runUntil(nextion, [&display]() { return display.bulkReceived.load() >= BulkCommands; }, 2000);
+
+    printf("full buffer: %zu filler bytes queued (%s), output held by the port: %s\n", filled,
+        full ? "kernel buffer full" : "kernel buffer NOT full", held ? "yes" : "no");
+    printf("bulk: %d/%d commands of %zu bytes received, %d corrupted, port error %d\n", display.bulkReceived.load(),
+        BulkCommands, BulkLength, display.bulkErrors.load(), port.error());
+
+    display.running = false;
+    simulator.join();
+
+    if (filler >= 0)
+        ::close(filler);
+
+    port.close();
+    ::close(master);
+
+    bool ok = received && full && held && delivered && display.bulkErrors.load() == 0 && port.error() == 0;
+
+    return ok ? 0 : 1;
+}
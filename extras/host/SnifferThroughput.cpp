@@ -0,0 +1,234 @@
+// Host benchmark: NextionSniffer cost with both directions at full line rate.
+//
+// Realistic traffic is generated for both directions: value and text
+// assignments, page changes and queries towards the display; acks, touches,
+// page reports, numeric and string returns from it. It is decoded twice:
+// - feed(): both directions at once from memory, giving the raw decode rate;
+// - update(): two in-memory Streams that receive one millisecond of 921600 baud
+//   traffic per direction (92 bytes) before each call, as a loop on a board
+//   would see them.
+// The CPU time of each run is reported together with the share of one core
+// needed to follow two 921600 baud lines. The program exits non-zero if a frame
+// is lost, mis-decoded or overflows.
+//
+//     ./SnifferThroughput [seconds of traffic]
+
+#include <Arduino.h>
+#include <NextionSniffer.h>
+#include <string.h>
+#include <time.h>
+
+// 921600 baud, 8N1
+const unsigned long LineBytesPerSecond = 92160;
+const unsigned long BytesPerUpdate = LineBytesPerSecond / 1000;
+
+// Growable byte buffer for the generated traffic
+struct Traffic {
+    uint8_t* data = nullptr;
+    size_t length = 0;
+    size_t capacity = 0;
+    unsigned long frames = 0;
+    int64_t valueSum = 0;
+
+    void append(const void* bytes, size_t count)
+    {
+        if (length + count > capacity)
+        {
+            capacity = (length + count) * 2;
+            data = static_cast<uint8_t*>(realloc(data, capacity));
+        }
+
+        memcpy(data + length, bytes, count);
+        length += count;
+    }
+
+    void frame(const void* payload, size_t count, int32_t value)
+    {
+        static const uint8_t terminator[] = { 0xFF, 0xFF, 0xFF };
+        append(payload, count);
+        append(terminator, sizeof(terminator));
+        frames++;
+        valueSum += value;
+    }
+};
+
+// Stream over a Traffic buffer; bytes become available a slice at a time
+class ReplayPort : public Stream {
+public:
+    explicit ReplayPort(const Traffic& traffic) : _traffic(traffic) {}
+
+    int available() override { return static_cast<int>(_arrived - _position); }
+    int read() override { return _position < _arrived ? _traffic.data[_position++] : -1; }
+    int peek() override { return _position < _arrived ? _traffic.data[_position] : -1; }
+    size_t write(uint8_t) override { return 0; }
+
+    using Print::write;
+
+    /// Let up to `count` more bytes arrive; false once everything has arrived
+    bool arrive(size_t count)
+    {
+        _arrived = _arrived + count < _traffic.length ? _arrived + count : _traffic.length;
+        return _position < _traffic.length;
+    }
+
+private:
+    const Traffic& _traffic;
+    size_t _position = 0;
+    size_t _arrived = 0;
+};
+
+static unsigned long frames[2];
+static int64_t valueSums[2];
+
+static void onFrame(const NextionSnifferRecord& record, const uint8_t*, size_t)
+{
+    frames[record.direction]++;
+    valueSums[record.direction] += record.value;
+}
+
+static void generate(Traffic& toDisplay, Traffic& fromDisplay, size_t bytesPerDirection)
+{
+    char command[48];
+    uint32_t seed = 12345;
+
+    for (uint32_t i = 0; toDisplay.length < bytesPerDirection; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int32_t value = static_cast<int32_t>(seed >> 8) - 0x400000;
+        int length;
+
+        switch (i % 4)
+        {
+            case 0: length = snprintf(command, sizeof(command), "n%u.val=%ld", i % 10, static_cast<long>(value)); break;
+            case 1: length = snprintf(command, sizeof(command), "page1.t%u.txt=\"%08lx\"", i % 10, static_cast<unsigned long>(seed)); value = 8; break;
+            case 2: length = snprintf(command, sizeof(command), "get n%u.val", i % 10); value = 0; break;
+            default: length = snprintf(command, sizeof(command), "page %u", i % 5); value = 0; break;
+        }
+
+        toDisplay.frame(command, static_cast<size_t>(length), value);
+    }
+
+    for (uint32_t i = 0; fromDisplay.length < bytesPerDirection; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+
+        switch (i % 5)
+        {
+            case 0:
+            {
+                const uint8_t ack[] = { 0x01 };
+                fromDisplay.frame(ack, sizeof(ack), 0);
+                break;
+            }
+
+            case 1:
+            {
+                const uint8_t touch[] = { 0x65, 0x01, static_cast<uint8_t>(i % 20), 0x01 };
+                fromDisplay.frame(touch, sizeof(touch), (1 << 16) | ((i % 20) << 8) | 1);
+                break;
+            }
+
+            case 2:
+            {
+                // Includes 0xFF data bytes (negative numbers) that return framing must keep
+                int32_t number = static_cast<int32_t>(seed) >> 4;
+                uint32_t bits = static_cast<uint32_t>(number);
+                const uint8_t numeric[] = { 0x71, static_cast<uint8_t>(bits), static_cast<uint8_t>(bits >> 8),
+                    static_cast<uint8_t>(bits >> 16), static_cast<uint8_t>(bits >> 24) };
+                fromDisplay.frame(numeric, sizeof(numeric), number);
+                break;
+            }
+
+            case 3:
+            {
+                const uint8_t page[] = { 0x66, static_cast<uint8_t>(i % 5) };
+                fromDisplay.frame(page, sizeof(page), static_cast<int32_t>(i % 5));
+                break;
+            }
+
+            default:
+            {
+                const uint8_t text[] = { 0x70, 'r', 'e', 'a', 'd', 'y' };
+                fromDisplay.frame(text, sizeof(text), static_cast<int32_t>(sizeof(text) - 1));
+                break;
+            }
+        }
+    }
+}
+
+static double cpuSeconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static bool check(const char* method, const NextionSniffer& sniffer, const Traffic traffic[2], double cpu, double seconds)
+{
+    bool ok = sniffer.overflowCount() == 0;
+
+    for (int direction = 0; direction < 2; direction++)
+    {
+        if (frames[direction] != traffic[direction].frames || valueSums[direction] != traffic[direction].valueSum)
+            ok = false;
+    }
+
+    double bytes = static_cast<double>(traffic[0].length + traffic[1].length);
+
+    printf("%s: %.1f MB in %.1f ms CPU, %.1f MB/s, %.3f%% of a core at 2 x 921600 baud; frames %lu/%lu and %lu/%lu%s\n",
+        method, bytes / 1e6, cpu * 1000, bytes / cpu / 1e6, cpu / seconds * 100, frames[0], traffic[0].frames, frames[1],
+        traffic[1].frames, ok ? "" : " - MISMATCH");
+
+    frames[0] = frames[1] = 0;
+    valueSums[0] = valueSums[1] = 0;
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 20;
+
+    if (seconds <= 0)
+        seconds = 20;
+
+    Traffic traffic[2];
+    generate(traffic[NextionSnifferRecord::ToDisplay], traffic[NextionSnifferRecord::FromDisplay],
+        LineBytesPerSecond * static_cast<unsigned long>(seconds));
+
+    // Raw decode rate, both directions interleaved in chunks like update() does
+    NextionSniffer fed(nullptr, nullptr, onFrame);
+    double start = cpuSeconds();
+
+    for (size_t offset = 0; offset < traffic[0].length || offset < traffic[1].length; offset += SnifferChunkSize)
+    {
+        for (uint8_t direction = 0; direction < 2; direction++)
+        {
+            if (offset < traffic[direction].length)
+            {
+                size_t count = traffic[direction].length - offset < SnifferChunkSize ? traffic[direction].length - offset : SnifferChunkSize;
+                fed.feed(direction, traffic[direction].data + offset, count);
+            }
+        }
+    }
+
+    bool ok = check("feed()  ", fed, traffic, cpuSeconds() - start, seconds);
+
+    // Stream path, one millisecond of line traffic per call
+    ReplayPort toDisplay(traffic[NextionSnifferRecord::ToDisplay]);
+    ReplayPort fromDisplay(traffic[NextionSnifferRecord::FromDisplay]);
+    NextionSniffer streamed(&toDisplay, &fromDisplay, onFrame);
+    start = cpuSeconds();
+
+    for (bool more = true; more;)
+    {
+        more = toDisplay.arrive(BytesPerUpdate);
+        more = fromDisplay.arrive(BytesPerUpdate) || more;
+        streamed.update();
+    }
+
+    ok = check("update()", streamed, traffic, cpuSeconds() - start, seconds) && ok;
+
+    free(traffic[0].data);
+    free(traffic[1].data);
+    return ok ? 0 : 1;
+}
@@ -1,5 +1,15 @@
 #pragma once
 
+#include "NextionFlash.h"
+#include "NextionGestureRecognizer.h"
+#include "NextionCommandTracker.h"
+#include "NextionHash.h"
+#include "NextionPreparedCommand.h"
+#include "NextionStringTable.h"
+#include "NextionTextEncoder.h"
+#include "NextionTouchTimer.h"
+#include "NextionWidgets.h"
+
 // Helper macro for casting PROGMEM pointers to __FlashStringHelper*
 // Used with static const char arrays stored in PROGMEM
 #ifndef FPSTR
@@ -26,6 +36,7 @@ class NextionControl;
  */
 class BaseDisplayPage {
 	friend class NextionControl;
+	friend class NextionWidget;
 
 public:
     /**
@@ -113,9 +124,66 @@ protected:
      */
     explicit BaseDisplayPage(Stream* serialPort) 
         : nextionSerialPort(serialPort), 
+          _stringTable(nullptr),
+          _codePage(nullptr),
+          _tracker(nullptr),
+          _widgets(nullptr),
+          _widgetsPending(false),
+          _stateGeneration(0),
           _initialized(false),
           _isActive(false) {}
 
+    /**
+     * @brief Set the flash string table used by the `NextionStringId` overloads.
+     *
+     * Typically called once from the derived class constructor.
+     *
+     * @param table Table of PROGMEM component names and fixed texts, or nullptr
+     *              to clear. Must remain valid for the lifetime of this page.
+     */
+    void setStringTable(const NextionStringTable* table) { _stringTable = table; }
+
+    /**
+     * @brief Set the code page the display fonts were generated for.
+     *
+     * When set, RAM texts passed to `sendText`, `sendGlobalText` and text
+     * widgets are treated as UTF-8: they are transcoded to the code page and
+     * have `"` and `\` escaped in a single streaming pass (see
+     * NextionTextEncoder.h). Texts stored in PROGMEM are sent unchanged.
+     *
+     * @param codePage Code page (e.g. `&CodePageWindows1252`), or nullptr (default)
+     *                 to send texts byte for byte. Must remain valid for the
+     *                 lifetime of this page.
+     */
+    void setTextEncoding(const NextionCodePage* codePage) { _codePage = codePage; }
+
+    /**
+     * @brief Send every widget of this page that holds an unsent value.
+     *
+     * Called by NextionControl after each `refresh()` and when the page becomes
+     * active. Pages may also call it directly to push changes immediately.
+     * Widgets held back by their rate limit are left pending and retried by
+     * NextionControl on every `update()` until they have been sent.
+     *
+     * @param now Current time in milliseconds.
+     */
+    void flushWidgets(unsigned long now);
+
+    /**
+     * @brief Mark every widget and text hash slot of this page for re-sending.
+     *
+     * Called by NextionControl when the page becomes active, as the display
+     * resets component attributes to their HMI defaults on page load. Widgets
+     * are re-sent on the next flush, except global widgets whose state the
+     * display keeps; `NextionTextHash` slots are invalidated by
+     * advancing the page's state generation, so the next `sendText` through each
+     * slot goes out unconditionally.
+     *
+     * @param includeGlobal Also invalidate global widgets. Used by NextionControl
+     *                      after a display restart, which clears global state too.
+     */
+    void invalidateWidgets(bool includeGlobal = false);
+
     /**
      * @brief Get the unique page identifier matching the Nextion HMI page ID.
      * @return Page ID (0-255) corresponding to the page number in the Nextion Editor.
@@ -123,6 +191,21 @@ protected:
      */
     virtual uint8_t getPageId() const = 0;
 
+    /**
+     * @brief Get the page name as defined in the Nextion Editor.
+     *
+     * Required only for pages with global components (`vscope=global`) that
+     * should be kept current while the page is inactive; qualified writes take
+     * the form `pageName.component.attr=value`.
+     *
+     * @return Page name stored in PROGMEM (use F() macro), or nullptr (default)
+     *         if the page does not support off-page updates.
+     */
+    virtual const __FlashStringHelper* getPageName() const
+    {
+        return nullptr;
+    }
+
     /**
      * @brief Called when this page becomes the active page.
      * 
@@ -183,7 +266,8 @@ protected:
      * - Initializing internal data structures
      * 
      * @note Called automatically by NextionControl before first page activation.
-     * @note Called only once per page lifetime.
+     * @note Called only once per page lifetime, unless the display restarts: then
+     *       it is called again so one-time display setup can be re-applied.
      * @note Must be implemented by derived classes.
      */
     virtual void begin() = 0;
@@ -244,6 +328,28 @@ protected:
         (void)responseCode;
     }
 
+    /**
+     * @brief Handle a command from this page that finally failed.
+     *
+     * Called only while acknowledgement tracking is enabled with
+     * `NextionControl::setAckTracking()`. Transient failures of prepared
+     * templates and widget values are retried with backoff first; this is called
+     * once the retries are exhausted, or straight away for other commands and
+     * permanent errors.
+     *
+     * @param command Identity of the failed command: compare `command.source`
+     *                with a prepared template or widget, or `command.hash` with
+     *                `NextionCommandTracker::hash()` of a raw command.
+     * @param responseCode Error code from Nextion, or `CommandTimeoutCode` if no
+     *                     acknowledgement arrived within `CommandAckTimeout`.
+     * @note Default implementation does nothing.
+     */
+    virtual void handleCommandFailure(const NextionCommandRecord& command, uint8_t responseCode)
+    {
+        (void)command;
+        (void)responseCode;
+    }
+
     /**
      * @brief Handle touch coordinate events.
      * 
@@ -261,6 +367,33 @@ protected:
         (void)eventType;
     }
 
+    /**
+     * @brief Handle a timed touch event of a component registered with a `NextionTouchTimer`.
+     *
+     * Called instead of `handleTouch()` for registered components.
+     *
+     * @param event Press, repeat, long press or debounced release.
+     * @note Default implementation does nothing.
+     */
+    virtual void handleTouchEvent(const NextionTouchEvent& event)
+    {
+        (void)event;
+    }
+
+    /**
+     * @brief Handle a recognized touch gesture.
+     *
+     * Called instead of `handleTouchXY()` when a `NextionGestureRecognizer` is
+     * attached with `NextionControl::setGestureRecognizer()`.
+     *
+     * @param gesture Tap, long press, swipe, drag movement or drag end.
+     * @note Default implementation does nothing.
+     */
+    virtual void handleGesture(const NextionGesture& gesture)
+    {
+        (void)gesture;
+    }
+
     /**
      * @brief Handle numeric return values from Nextion.
      * 
@@ -343,7 +476,7 @@ protected:
             return;
         }
 
-        nextionSerialPort->print(cmd);
+        NextionFlash::write(nextionSerialPort, cmd);
         endCommand();
     }
 
@@ -392,14 +525,101 @@ protected:
         if (!_isActive)
             return;
 
-        nextionSerialPort->print(component);
+        NextionFlash::write(nextionSerialPort, component);
         nextionSerialPort->print('.');
-        nextionSerialPort->print(property);
+        NextionFlash::write(nextionSerialPort, property);
         nextionSerialPort->print('=');
         nextionSerialPort->print(value);
         endCommand();
     }
 
+    /**
+     * @brief Send a prepared command with a numeric slot value.
+     *
+     * Only the slot bytes are formatted; the whole command, terminator included,
+     * is written to the port in one call.
+     *
+     * @param command Prepared command template (see NextionPreparedCommand.h)
+     * @param value Value for the slot
+     * @note Only sends if page is active.
+     */
+    void sendPrepared(NextionPreparedCommandBase& command, int32_t value)
+    {
+        if (!nextionSerialPort || !_isActive)
+            return;
+
+        size_t length = command.format(value);
+        if (length == 0)
+            return;
+
+        trackSource(NextionCommandRecord::KindPrepared, &command);
+        nextionSerialPort->write(command.data(), length);
+    }
+
+    /**
+     * @brief Send a prepared command with a text slot value.
+     *
+     * @param command Prepared command template (see NextionPreparedCommand.h)
+     * @param text Text for the slot; truncated if it does not fit
+     * @note Only sends if page is active.
+     */
+    void sendPrepared(NextionPreparedCommandBase& command, const char* text)
+    {
+        if (!nextionSerialPort || !text || !_isActive)
+            return;
+
+        size_t length = command.format(text);
+        if (length == 0)
+            return;
+
+        trackSource(NextionCommandRecord::KindPrepared, &command);
+        nextionSerialPort->write(command.data(), length);
+    }
+
+    /**
+     * @brief Set a property of a global component, even while the page is inactive.
+     *
+     * When the page is active this behaves like `setComponentProperty()`. When
+     * inactive, a qualified `pageName.component.property=value` write is sent,
+     * which the display applies to components with `vscope=global`.
+     *
+     * @param component Component name stored in PROGMEM (use F() macro)
+     * @param property Property name stored in PROGMEM (use F() macro)
+     * @param value Numeric value to assign
+     * @note Nothing is sent from an inactive page that does not implement `getPageName()`.
+     */
+    void setGlobalComponentProperty(const __FlashStringHelper* component, const __FlashStringHelper* property, int32_t value)
+    {
+        if (!nextionSerialPort || !component || !property)
+            return;
+
+        bool qualified = !_isActive;
+        if (qualified && !getPageName())
+            return;
+
+        writeProperty(component, property, value, qualified);
+    }
+
+    /**
+     * @brief Set the text of a global component, even while the page is inactive.
+     *
+     * @param component Component name stored in PROGMEM (use F() macro)
+     * @param text Text string to display (RAM)
+     * @note Nothing is sent from an inactive page that does not implement `getPageName()`.
+     */
+    void sendGlobalText(const __FlashStringHelper* component, const char* text)
+    {
+        if (!nextionSerialPort || !component || !text)
+            return;
+
+        bool qualified = !_isActive;
+        if (qualified && !getPageName())
+            return;
+
+        writeComponentName(component, qualified);
+        writeTextValue(text, strlen(text));
+    }
+
     /**
      * @brief Switch to a different page on the Nextion display.
      * 
@@ -421,6 +641,80 @@ protected:
         endCommand();
 	}
 
+    /**
+     * @brief Show or hide a component.
+     *
+     * Sends `vis <component>,<0|1>`.
+     *
+     * @param component Component name (e.g., "t0")
+     * @param visible true to show, false to hide
+     * @note Only sends if page is active.
+     */
+    void setVisible(const char* component, bool visible)
+    {
+        if (!nextionSerialPort || !component)
+            return;
+
+        if (!_isActive)
+            return;
+
+        NextionFlash::write(nextionSerialPort, PSTR("vis "));
+        nextionSerialPort->print(component);
+        writeVisibility(visible);
+    }
+
+    /**
+     * @brief Show or hide a component (PROGMEM component name).
+     *
+     * @param component Component name stored in PROGMEM (use F() macro)
+     * @param visible true to show, false to hide
+     * @note Only sends if page is active.
+     */
+    void setVisible(const __FlashStringHelper* component, bool visible)
+    {
+        if (!nextionSerialPort || !component)
+            return;
+
+        if (!_isActive)
+            return;
+
+        NextionFlash::write(nextionSerialPort, PSTR("vis "));
+        NextionFlash::write(nextionSerialPort, component);
+        writeVisibility(visible);
+    }
+
+    /**
+     * @brief Show or hide the component bound to a widget, tracking its visibility.
+     *
+     * While hidden, changes to the widget are held instead of being sent. When
+     * shown, the widget's latest value is sent immediately (bypassing its rate
+     * limit) followed by `vis <component>,1`, so the component appears with
+     * current content.
+     *
+     * If the page is not active only the tracked state changes; a hidden widget
+     * is re-hidden when the page is next entered.
+     *
+     * @param widget Widget bound to this page
+     * @param visible true to show, false to hide
+     */
+    void setVisible(NextionWidget& widget, bool visible)
+    {
+        NextionWidget* widgets[1] = { &widget };
+        setVisible(widgets, 1, visible);
+    }
+
+    /**
+     * @brief Show or hide a group of widgets in one batch.
+     *
+     * When showing, all held values are sent first and then all `vis` commands,
+     * back to back within this call.
+     *
+     * @param widgets Array of widgets bound to this page
+     * @param count Number of entries in `widgets`
+     * @param visible true to show, false to hide
+     */
+    void setVisible(NextionWidget* const* widgets, uint8_t count, bool visible);
+
     /**
      * @brief Set the primary picture attribute of a component.
      * 
@@ -432,6 +726,28 @@ protected:
         setComponentProperty(component, "pic", pictureId);
     }
 
+    /**
+     * @brief Set the primary picture attribute of a component (PROGMEM component name).
+     *
+     * @param component Component name stored in PROGMEM (use F() macro)
+     * @param pictureId Picture resource ID from Nextion Editor
+     */
+    void setPicture(const __FlashStringHelper* component, int32_t pictureId)
+    {
+        setComponentProperty(component, F("pic"), pictureId);
+    }
+
+    /**
+     * @brief Set the primary picture attribute of a component (string table name).
+     *
+     * @param component Index of the component name in the page string table
+     * @param pictureId Picture resource ID from Nextion Editor
+     */
+    void setPicture(NextionStringId component, int32_t pictureId)
+    {
+        setFlashComponentProperty(lookupString(component), PSTR("pic"), pictureId);
+    }
+
     /**
      * @brief Set the secondary picture attribute of a component (e.g., button pressed state).
      * 
@@ -443,6 +759,28 @@ protected:
         setComponentProperty(component, "pic2", pictureId);
     }
 
+    /**
+     * @brief Set the secondary picture attribute of a component (PROGMEM component name).
+     *
+     * @param component Component name stored in PROGMEM (use F() macro)
+     * @param pictureId Picture resource ID from Nextion Editor
+     */
+    void setPicture2(const __FlashStringHelper* component, int32_t pictureId)
+    {
+        setComponentProperty(component, F("pic2"), pictureId);
+    }
+
+    /**
+     * @brief Set the secondary picture attribute of a component (string table name).
+     *
+     * @param component Index of the component name in the page string table
+     * @param pictureId Picture resource ID from Nextion Editor
+     */
+    void setPicture2(NextionStringId component, int32_t pictureId)
+    {
+        setFlashComponentProperty(lookupString(component), PSTR("pic2"), pictureId);
+    }
+
     /**
      * @brief Set the font attribute of a text component.
      * 
@@ -454,6 +792,41 @@ protected:
         setComponentProperty(component, "font", fontId);
     }
 
+    /**
+     * @brief Set the font attribute of a text component (PROGMEM component name).
+     *
+     * @param component Component name stored in PROGMEM (use F() macro)
+     * @param fontId Font resource ID from Nextion Editor
+     */
+    void setFont(const __FlashStringHelper* component, int32_t fontId)
+    {
+        setComponentProperty(component, F("font"), fontId);
+    }
+
+    /**
+     * @brief Set the font attribute of a text component (string table name).
+     *
+     * @param component Index of the component name in the page string table
+     * @param fontId Font resource ID from Nextion Editor
+     */
+    void setFont(NextionStringId component, int32_t fontId)
+    {
+        setFlashComponentProperty(lookupString(component), PSTR("font"), fontId);
+    }
+
+    /**
+     * @brief Set a property value on a Nextion component (string table names).
+     *
+     * @param component Index of the component name in the page string table
+     * @param property Index of the property name in the page string table
+     * @param value Numeric value to assign
+     * @note Nothing is sent if either index is not present in the table.
+     */
+    void setComponentProperty(NextionStringId component, NextionStringId property, int32_t value)
+    {
+        setFlashComponentProperty(lookupString(component), lookupString(property), value);
+    }
+
     /**
      * @brief Set a numeric value on a component.
      * 
@@ -497,7 +870,30 @@ protected:
         if (!_isActive)
             return;
 
-        nextionSerialPort->print(component);
+        NextionFlash::write(nextionSerialPort, component);
+        nextionSerialPort->print('=');
+        nextionSerialPort->print(value);
+        endCommand();
+    }
+
+    /**
+     * @brief Set a numeric value on a component (string table name).
+     *
+     * @param component Index of the component name in the page string table
+     * @param value Numeric value to assign
+     * @note Nothing is sent if the index is not present in the table.
+     */
+    void sendValue(NextionStringId component, int32_t value)
+    {
+        PGM_P name = lookupString(component);
+
+        if (!nextionSerialPort || !name)
+            return;
+
+        if (!_isActive)
+            return;
+
+        NextionFlash::write(nextionSerialPort, name);
         nextionSerialPort->print('=');
         nextionSerialPort->print(value);
         endCommand();
@@ -522,10 +918,7 @@ protected:
 
         // Stream directly: component.txt="text"
         nextionSerialPort->print(component);
-        nextionSerialPort->print(F(".txt=\""));
-        nextionSerialPort->print(text);
-        nextionSerialPort->print('"');
-        endCommand();
+        writeTextValue(text, strlen(text));
     }
 
     /**
@@ -545,15 +938,14 @@ protected:
         if (!_isActive)
             return;
 
+#ifdef NEXTION_DEBUG
         Serial.print("a.Sending text to component : ");
         Serial.println(component);
         Serial.print("Text: ");
         Serial.println(text);
-        nextionSerialPort->print(component);
-        nextionSerialPort->print(F(".txt=\""));
-        nextionSerialPort->print(text);
-        nextionSerialPort->print('"');
-        endCommand();
+#endif
+        NextionFlash::write(nextionSerialPort, component);
+        writeTextValue(text, strlen(text));
     }
 
     /**
@@ -572,31 +964,477 @@ protected:
 
         if (!_isActive)
             return;
+#ifdef NEXTION_DEBUG
 		Serial.print("b.Sending text to component: ");
 		Serial.println(component);
 		Serial.print("Text: ");
 		Serial.println(text);
+#endif
+        NextionFlash::write(nextionSerialPort, component);
+        NextionFlash::write(nextionSerialPort, PSTR(".txt=\""));
+        NextionFlash::write(nextionSerialPort, text);
+        nextionSerialPort->print('"');
+        endCommand();
+    }
+
+    /**
+     * @brief Set the text attribute of a component only if it has changed.
+     *
+     * The text is hashed while it is measured for the block write, and the send
+     * is skipped if the hash matches the one recorded in `last`. After
+     * `forceAfter` consecutive skips the text is sent anyway to guard against
+     * hash collisions.
+     *
+     * @param component Component name (e.g., "t0")
+     * @param text Text string to display
+     * @param last Last-sent state for this component
+     * @param forceAfter Re-send after this many consecutive skips (0 = never force, at most 254)
+     */
+    void sendText(const char* component, const char* text, NextionTextHash& last, uint8_t forceAfter = TextHashForceAfter)
+    {
+        if (!nextionSerialPort || !component || !text)
+            return;
+
+        if (!_isActive)
+            return;
+
+        size_t length;
+        if (!last.changed(NextionHash::fold(NextionHash::text(text, length)), _stateGeneration, forceAfter))
+            return;
+
         nextionSerialPort->print(component);
-        nextionSerialPort->print(F(".txt=\""));
-        nextionSerialPort->print(text);
+        writeTextValue(text, length);
+    }
+
+    /**
+     * @brief Set the text attribute of a component only if it has changed (PROGMEM component name).
+     *
+     * @param component Component name stored in PROGMEM (use F() macro)
+     * @param text Text string to display (RAM)
+     * @param last Last-sent state for this component
+     * @param forceAfter Re-send after this many consecutive skips (0 = never force, at most 254)
+     */
+    void sendText(const __FlashStringHelper* component, const char* text, NextionTextHash& last, uint8_t forceAfter = TextHashForceAfter)
+    {
+        if (!nextionSerialPort || !component || !text)
+            return;
+
+        if (!_isActive)
+            return;
+
+        size_t length;
+        if (!last.changed(NextionHash::fold(NextionHash::text(text, length)), _stateGeneration, forceAfter))
+            return;
+
+        NextionFlash::write(nextionSerialPort, component);
+        writeTextValue(text, length);
+    }
+
+    /**
+     * @brief Set the text attribute of a component only if it has changed (string table name).
+     *
+     * @param component Index of the component name in the page string table
+     * @param text Text string to display (RAM)
+     * @param last Last-sent state for this component
+     * @param forceAfter Re-send after this many consecutive skips (0 = never force, at most 254)
+     */
+    void sendText(NextionStringId component, const char* text, NextionTextHash& last, uint8_t forceAfter = TextHashForceAfter)
+    {
+        PGM_P name = lookupString(component);
+
+        if (!nextionSerialPort || !name || !text)
+            return;
+
+        if (!_isActive)
+            return;
+
+        size_t length;
+        if (!last.changed(NextionHash::fold(NextionHash::text(text, length)), _stateGeneration, forceAfter))
+            return;
+
+        NextionFlash::write(nextionSerialPort, name);
+        writeTextValue(text, length);
+    }
+
+    /**
+     * @brief Set the text attribute of a component (string table name, RAM text).
+     *
+     * @param component Index of the component name in the page string table
+     * @param text Text string to display (RAM)
+     * @note Nothing is sent if the index is not present in the table.
+     */
+    void sendText(NextionStringId component, const char* text)
+    {
+        PGM_P name = lookupString(component);
+
+        if (!nextionSerialPort || !name || !text)
+            return;
+
+        if (!_isActive)
+            return;
+
+        NextionFlash::write(nextionSerialPort, name);
+        writeTextValue(text, strlen(text));
+    }
+
+    /**
+     * @brief Set the text attribute of a component (string table name and text).
+     *
+     * Both the component name and the text are streamed from flash in block writes.
+     *
+     * @param component Index of the component name in the page string table
+     * @param text Index of the text in the page string table
+     * @note Nothing is sent if either index is not present in the table.
+     */
+    void sendText(NextionStringId component, NextionStringId text)
+    {
+        PGM_P name = lookupString(component);
+        PGM_P value = lookupString(text);
+
+        if (!nextionSerialPort || !name || !value)
+            return;
+
+        if (!_isActive)
+            return;
+
+        NextionFlash::write(nextionSerialPort, name);
+        NextionFlash::write(nextionSerialPort, PSTR(".txt=\""));
+        NextionFlash::write(nextionSerialPort, value);
         nextionSerialPort->print('"');
         endCommand();
     }
 
 private:
     Stream* nextionSerialPort;
+
+    const NextionStringTable* _stringTable;
+
+    /// @brief Target code page for RAM texts, or nullptr to send them unchanged.
+    const NextionCodePage* _codePage;
+
+    /// @brief Acknowledgement tracker set by NextionControl, or nullptr.
+    NextionCommandTracker* _tracker;
+
+    /// @brief Head of the list of widgets bound to this page.
+    NextionWidget* _widgets;
+
+    /// @brief true when a rate-limited widget is waiting for its send window.
+    bool _widgetsPending;
+
+    /// @brief Advanced whenever the display may have lost this page's component state.
+    uint32_t _stateGeneration;
     
     bool _initialized;
     bool _isActive;
 
+    PGM_P lookupString(NextionStringId id) const
+    {
+        return _stringTable ? _stringTable->get(id) : nullptr;
+    }
+
+    /// @brief setComponentProperty() for names already resolved from the string table.
+    void setFlashComponentProperty(PGM_P component, PGM_P property, int32_t value)
+    {
+        if (!nextionSerialPort || !component || !property)
+            return;
+
+        if (!_isActive)
+            return;
+
+        NextionFlash::write(nextionSerialPort, component);
+        nextionSerialPort->print('.');
+        NextionFlash::write(nextionSerialPort, property);
+        nextionSerialPort->print('=');
+        nextionSerialPort->print(value);
+        endCommand();
+    }
+
+    /// @brief Write the component name, prefixed with `pageName.` for a qualified write.
+    void writeComponentName(const __FlashStringHelper* component, bool qualified)
+    {
+        if (qualified)
+        {
+            NextionFlash::write(nextionSerialPort, getPageName());
+            nextionSerialPort->print('.');
+        }
+
+        NextionFlash::write(nextionSerialPort, component);
+    }
+
+    /// @brief Write `[pageName.]component.property=value` and the terminator.
+    void writeProperty(const __FlashStringHelper* component, const __FlashStringHelper* property, int32_t value, bool qualified)
+    {
+        writeComponentName(component, qualified);
+        nextionSerialPort->print('.');
+        NextionFlash::write(nextionSerialPort, property);
+        nextionSerialPort->print('=');
+        nextionSerialPort->print(value);
+        endCommand();
+    }
+
+    /**
+     * @brief Send pending global widgets while this page is inactive.
+     *
+     * Called by NextionControl at low priority for pages other than the current one.
+     *
+     * @param now Current time in milliseconds.
+     */
+    void flushGlobalWidgets(unsigned long now);
+
+    /// @brief Write `,0` or `,1` and the terminator once `vis <component>` has been written.
+    void writeVisibility(bool visible)
+    {
+        nextionSerialPort->print(',');
+        nextionSerialPort->print(visible ? '1' : '0');
+        endCommand();
+    }
+
+    /**
+     * @brief Write `.txt="<text>"` and the terminator once the component name has been written.
+     *
+     * With a code page set the text is transcoded and escaped on the way out;
+     * otherwise it is written as one block.
+     */
+    void writeTextValue(const char* text, size_t length)
+    {
+        NextionFlash::write(nextionSerialPort, PSTR(".txt=\""));
+
+        if (_codePage)
+            NextionTextEncoder::write(nextionSerialPort, text, length, _codePage);
+        else
+            nextionSerialPort->write(reinterpret_cast<const uint8_t*>(text), length);
+
+        nextionSerialPort->print('"');
+        endCommand();
+    }
+
+    /// @brief Attribute the next command to a prepared template or widget when tracking acks.
+    void trackSource(uint8_t kind, const void* source)
+    {
+        if (_tracker)
+            _tracker->setSource(kind, source, this);
+    }
+
+    /**
+     * @brief Re-send a widget whose write failed.
+     * @param widget Widget bound to this page.
+     * @param attempts Retry count for the new send.
+     * @param now Current time in milliseconds.
+     */
+    void retryWidget(NextionWidget* widget, uint8_t attempts, unsigned long now);
+
     void endCommand()
     {
         if (!nextionSerialPort)
             return;
-        nextionSerialPort->write(0xFF);
-        nextionSerialPort->write(0xFF);
-        nextionSerialPort->write(0xFF);
+
+        static const uint8_t terminator[3] = { 0xFF, 0xFF, 0xFF };
+        nextionSerialPort->write(terminator, sizeof(terminator));
     }
     
     friend class NextionControl;  // Allow NextionControl to access _initialized and _isActive
 };
+
+
+inline NextionWidget::NextionWidget(BaseDisplayPage* page, const __FlashStringHelper* component, WidgetType type)
+    : _flags(static_cast<uint8_t>(type << TypeShift)),
+      _next(nullptr),
+      _component(component)
+{
+    if (!page)
+        return;
+
+    // Append so widgets are flushed in declaration order
+    NextionWidget** link = &page->_widgets;
+    while (*link)
+        link = &(*link)->_next;
+
+    *link = this;
+}
+
+inline bool NextionWidget::flush(BaseDisplayPage* page, unsigned long now)
+{
+    if (!page->nextionSerialPort || !_component)
+        return false;
+
+    // Inactive pages can only update global components, through qualified writes
+    bool qualified = !page->_isActive;
+    if (qualified && (!(_flags & FlagGlobal) || !page->getPageName()))
+        return false;
+
+    if (_flags & FlagHidden)
+    {
+        // Hold updates while hidden; after a page reload re-apply the hidden state
+        if (!qualified && (_flags & FlagForce))
+        {
+            page->setVisible(_component, false);
+            _flags &= ~FlagForce;
+        }
+
+        return false;
+    }
+
+    if (!(_flags & FlagDirty))
+        return false;
+
+    if (!(_flags & FlagForce) && !_rateLimit.allowed(now))
+    {
+        // Newest value stays pending; NextionControl::update() retries it
+        page->_widgetsPending = true;
+        return false;
+    }
+
+    if (getType() != TypeText)
+        page->trackSource(NextionCommandRecord::KindWidget, this);
+
+    bool written = true;
+
+    switch (getType())
+    {
+        case TypeNumber:
+            page->writeProperty(_component, F("val"), static_cast<NumberWidget*>(this)->_value, qualified);
+            break;
+
+        case TypeProgress:
+            page->writeProperty(_component, F("val"), static_cast<ProgressWidget*>(this)->_value, qualified);
+            break;
+
+        case TypeGauge:
+            page->writeProperty(_component, F("val"), static_cast<GaugeWidget*>(this)->_value, qualified);
+            break;
+
+        case TypePicture:
+            page->writeProperty(_component, F("pic"), static_cast<PictureWidget*>(this)->_picture, qualified);
+            break;
+
+        case TypeText:
+        {
+            TextWidget* textWidget = static_cast<TextWidget*>(this);
+            const char* text = textWidget->_text;
+            size_t length;
+
+            // Global components keep their text across page loads, so ignore the page generation
+            uint32_t generation = (_flags & FlagGlobal) ? 0 : page->_stateGeneration;
+
+            if (text && textWidget->_lastSent.changed(NextionHash::fold(NextionHash::text(text, length)), generation, TextHashForceAfter))
+            {
+                page->trackSource(NextionCommandRecord::KindWidget, this);
+                page->writeComponentName(_component, qualified);
+                page->writeTextValue(text, length);
+            }
+            else
+            {
+                written = false;
+            }
+
+            break;
+        }
+    }
+
+    // An unchanged text costs nothing on the link, so it keeps the rate-limit token
+    if (written)
+        _rateLimit.consume(now);
+
+    _flags &= ~(FlagDirty | FlagForce);
+
+    return written;
+}
+
+inline void BaseDisplayPage::flushWidgets(unsigned long now)
+{
+    _widgetsPending = false;
+
+    for (NextionWidget* widget = _widgets; widget; widget = widget->_next)
+        widget->flush(this, now);
+}
+
+inline void NextionWidget::invalidate()
+{
+    if (_flags & FlagHidden)
+        _flags |= FlagForce;
+
+    if (!(_flags & FlagHasValue))
+        return;
+
+    _flags |= FlagDirty | FlagForce;
+
+    if (getType() == TypeText)
+        static_cast<TextWidget*>(this)->_lastSent.reset();
+}
+
+inline void BaseDisplayPage::setVisible(NextionWidget* const* widgets, uint8_t count, bool visible)
+{
+    if (!widgets)
+        return;
+
+    if (!visible)
+    {
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (!widgets[i])
+                continue;
+
+            widgets[i]->_flags |= NextionWidget::FlagHidden;
+            setVisible(widgets[i]->_component, false);
+        }
+
+        return;
+    }
+
+    unsigned long now = millis();
+
+    // Flush the latest held state first so components appear with current content
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (!widgets[i])
+            continue;
+
+        widgets[i]->_flags &= ~NextionWidget::FlagHidden;
+
+        if (widgets[i]->_flags & NextionWidget::FlagDirty)
+        {
+            widgets[i]->_flags |= NextionWidget::FlagForce;
+            widgets[i]->flush(this, now);
+        }
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (widgets[i])
+            setVisible(widgets[i]->_component, true);
+    }
+}
+
+inline void BaseDisplayPage::invalidateWidgets(bool includeGlobal)
+{
+    _stateGeneration++;
+
+    // Global components keep their state on the display across page loads
+    for (NextionWidget* widget = _widgets; widget; widget = widget->_next)
+    {
+        if (includeGlobal || !widget->isGlobal())
+            widget->invalidate();
+    }
+}
+
+inline void BaseDisplayPage::flushGlobalWidgets(unsigned long now)
+{
+    for (NextionWidget* widget = _widgets; widget; widget = widget->_next)
+    {
+        if (widget->isGlobal())
+            widget->flush(this, now);
+    }
+}
+
+inline void BaseDisplayPage::retryWidget(NextionWidget* widget, uint8_t attempts, unsigned long now)
+{
+    if (!_tracker)
+        return;
+
+    _tracker->setAttempts(attempts);
+    widget->invalidate();
+
+    // Nothing was written (page left, widget hidden): do not attribute the retry to another command
+    if (!widget->flush(this, now))
+        _tracker->cancelSource();
+}
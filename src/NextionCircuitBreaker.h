@@ -0,0 +1,229 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionCircuitBreaker.h
+ * @brief Suppression of commands to components that keep failing.
+ *
+ * A misspelt component name, or an HMI file that does not match the firmware,
+ * makes every `refresh()` send commands that the display rejects with 0x02
+ * (invalid component) or 0x1A (invalid variable). A `NextionCircuitBreaker`
+ * attributes these errors to their target, the component path of the command
+ * (`n0` for `n0.val=5`, `status.n0` for `status.n0.val=5`) on the page that was
+ * active when it was sent, and after `CircuitBreakerThreshold` consecutive
+ * failures suppresses further sends to that target:
+ * - The breaker stays open for `CircuitBreakerOpenTime`, doubling on each
+ *   re-trip up to `CircuitBreakerMaxShift` doublings.
+ * - Once the period has elapsed sends are let through again; a success closes
+ *   the breaker, another failure re-opens it straight away.
+ * - Each entry counts the sends it suppressed, giving a precise field
+ *   diagnostic of which targets are broken.
+ *
+ * Attribution requires acknowledgement tracking; attach the breaker to the
+ * tracker passed to `NextionControl::setAckTracking()`:
+ * @code
+ * NextionCommandTracker tracker(&Serial2);
+ * NextionCircuitBreaker breaker;
+ *
+ * tracker.setCircuitBreaker(&breaker);
+ * nextion.setAckTracking(&tracker);
+ * @endcode
+ *
+ * RAM: `CircuitBreakerSlots` entries of 12 bytes (AVR).
+ */
+
+class BaseDisplayPage;
+
+/// Number of failing targets tracked at once.
+const uint8_t CircuitBreakerSlots = 8;
+
+/// Consecutive failures after which a target is suppressed.
+const uint8_t CircuitBreakerThreshold = 3;
+
+/// Time (ms) a target stays suppressed after its first trip.
+const unsigned long CircuitBreakerOpenTime = 30000;
+
+/// Maximum number of times the suppression period is doubled on repeated trips.
+const uint8_t CircuitBreakerMaxShift = 4;
+
+/**
+ * @struct NextionCircuitBreakerEntry
+ * @brief Failure state of one (page, component) target.
+ */
+struct NextionCircuitBreakerEntry {
+    /// @brief Page active when the failing commands were sent (nullptr = free slot).
+    BaseDisplayPage* page;
+
+    /// @brief Folded FNV-1a hash of the component path; compare with `NextionCommandTracker::hash("n0")`.
+    uint16_t target;
+
+    /// @brief Consecutive failures since the last success.
+    uint8_t failures;
+
+    /// @brief Number of times the breaker has opened since the last success.
+    uint8_t trips;
+
+    /// @brief `millis()` at which the current suppression period ends.
+    unsigned long openUntil;
+
+    /// @brief Number of sends suppressed (saturates at 65535).
+    uint16_t suppressed;
+};
+
+/**
+ * @class NextionCircuitBreaker
+ * @brief Fixed table of failing targets with suppression back-off.
+ */
+class NextionCircuitBreaker {
+public:
+    NextionCircuitBreaker()
+    {
+        reset();
+    }
+
+    /**
+     * @brief Decide whether a command to a target may be sent.
+     * @param page Page active when the command is sent.
+     * @param target Hash of the command's component path.
+     * @param now Current time in milliseconds.
+     * @return false if the target is suppressed (the suppression is counted).
+     */
+    bool allow(BaseDisplayPage* page, uint16_t target, unsigned long now)
+    {
+        NextionCircuitBreakerEntry* entry = find(page, target);
+
+        if (!entry || entry->trips == 0 || static_cast<long>(now - entry->openUntil) >= 0)
+            return true;
+
+        if (entry->suppressed < 0xFFFF)
+            entry->suppressed++;
+
+        return false;
+    }
+
+    /**
+     * @brief Record a failed command.
+     * @param page Page active when the command was sent.
+     * @param target Hash of the command's component path.
+     * @param now Current time in milliseconds.
+     */
+    void recordFailure(BaseDisplayPage* page, uint16_t target, unsigned long now)
+    {
+        if (!page)
+            return;
+
+        NextionCircuitBreakerEntry* entry = find(page, target);
+
+        if (!entry)
+        {
+            entry = allocate();
+            entry->page = page;
+            entry->target = target;
+            entry->failures = 0;
+            entry->trips = 0;
+            entry->suppressed = 0;
+        }
+
+        if (entry->failures < 0xFF)
+            entry->failures++;
+
+        // A half-open breaker re-opens on its first failure
+        if (entry->failures >= CircuitBreakerThreshold || entry->trips > 0)
+        {
+            uint8_t shift = entry->trips < CircuitBreakerMaxShift ? entry->trips : CircuitBreakerMaxShift;
+
+            if (entry->trips < 0xFF)
+                entry->trips++;
+
+            entry->openUntil = now + (CircuitBreakerOpenTime << shift);
+        }
+    }
+
+    /**
+     * @brief Record a successful command, closing the target's breaker.
+     * @param page Page active when the command was sent.
+     * @param target Hash of the command's component path.
+     */
+    void recordSuccess(BaseDisplayPage* page, uint16_t target)
+    {
+        NextionCircuitBreakerEntry* entry = find(page, target);
+        if (!entry)
+            return;
+
+        // Keep the suppression count for diagnostics; the slot can be reused
+        entry->failures = 0;
+        entry->trips = 0;
+    }
+
+    /**
+     * @brief Check whether a tracked target is currently suppressed.
+     * @param index Slot index (0 to `CircuitBreakerSlots` - 1).
+     * @param now Current time in milliseconds.
+     */
+    bool isOpen(uint8_t index, unsigned long now) const
+    {
+        const NextionCircuitBreakerEntry& entry = _entries[index];
+        return entry.page && entry.trips > 0 && static_cast<long>(now - entry.openUntil) < 0;
+    }
+
+    /**
+     * @brief Access a slot for diagnostics.
+     * @param index Slot index (0 to `CircuitBreakerSlots` - 1). Free slots have a null `page`.
+     */
+    const NextionCircuitBreakerEntry& entry(uint8_t index) const { return _entries[index]; }
+
+    /// @brief Total sends suppressed across all tracked targets.
+    uint32_t suppressedCount() const
+    {
+        uint32_t total = 0;
+
+        for (uint8_t i = 0; i < CircuitBreakerSlots; i++)
+        {
+            if (_entries[i].page)
+                total += _entries[i].suppressed;
+        }
+
+        return total;
+    }
+
+    /// @brief Forget all targets.
+    void reset()
+    {
+        for (uint8_t i = 0; i < CircuitBreakerSlots; i++)
+            _entries[i].page = nullptr;
+    }
+
+private:
+    NextionCircuitBreakerEntry* find(BaseDisplayPage* page, uint16_t target)
+    {
+        for (uint8_t i = 0; i < CircuitBreakerSlots; i++)
+        {
+            if (_entries[i].page == page && _entries[i].target == target && page)
+                return &_entries[i];
+        }
+
+        return nullptr;
+    }
+
+    /// @brief Take a free slot, else the healthiest one (closed, fewest failures).
+    NextionCircuitBreakerEntry* allocate()
+    {
+        NextionCircuitBreakerEntry* best = &_entries[0];
+
+        for (uint8_t i = 0; i < CircuitBreakerSlots; i++)
+        {
+            NextionCircuitBreakerEntry* entry = &_entries[i];
+
+            if (!entry->page)
+                return entry;
+
+            if (entry->trips < best->trips || (entry->trips == best->trips && entry->failures < best->failures))
+                best = entry;
+        }
+
+        return best;
+    }
+
+    NextionCircuitBreakerEntry _entries[CircuitBreakerSlots];
+};
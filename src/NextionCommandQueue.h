@@ -0,0 +1,294 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionCommandQueue.h
+ * @brief Lock-free multi-producer submission queue of pre-encoded commands.
+ *
+ * Page helpers write straight to the shared `Stream`, so two tasks sending at
+ * the same time interleave bytes mid-command. Other tasks (on either core) and
+ * ISRs instead `post()` complete commands to a `NextionCommandQueue`, which
+ * the task owning `NextionControl::update()` drains in order:
+ * - Bounded ring of fixed-size slots (Vyukov's sequence-numbered queue):
+ *   producers claim a slot with a single compare-and-swap, copy the command
+ *   and publish it; they never wait, so posting from an ISR is safe.
+ * - Commands are encoded by the producer (`post()`, `postValue()`), so the
+ *   consumer only copies bytes to the port.
+ * - Back-pressure: `post()` returns false when the queue is full or the command
+ *   does not fit a slot; `isCongested()` reports when it is three quarters full
+ *   so producers can skip non-essential updates early.
+ *
+ * @code
+ * NextionCommandQueue<16, 48> displayQueue;
+ *
+ * void sensorTask(void*)
+ * {
+ *     for (;;)
+ *     {
+ *         displayQueue.postValue(F("n0.val="), readSensor());
+ *         vTaskDelay(pdMS_TO_TICKS(100));
+ *     }
+ * }
+ *
+ * void setup() { nextion.setCommandQueue(&displayQueue); }
+ * @endcode
+ *
+ * Requires `std::atomic` (ESP32, RP2040, host builds). Where `<atomic>` is not
+ * available (AVR) the header defines nothing and `NEXTION_COMMAND_QUEUE` is
+ * left undefined.
+ */
+
+#if defined(__has_include)
+#if __has_include(<atomic>)
+#define NEXTION_COMMAND_QUEUE 1
+#endif
+#endif
+
+#ifdef NEXTION_COMMAND_QUEUE
+
+#include <atomic>
+
+/// Maximum number of queued commands sent per `NextionControl::update()` pass.
+const uint8_t CommandQueueDrainLimit = 8;
+
+/**
+ * @class NextionCommandQueueBase
+ * @brief Capacity-independent part of the queue.
+ *
+ * Storage is supplied by `NextionCommandQueue`.
+ */
+class NextionCommandQueueBase {
+public:
+    /**
+     * @brief Post a command (without terminator).
+     * @param command Command bytes.
+     * @param length Number of bytes.
+     * @return false if the queue is full or the command exceeds the slot size.
+     */
+    bool post(const char* command, size_t length)
+    {
+        uint8_t* slot;
+        uint32_t position;
+
+        if (length > _slotSize || !claim(slot, position))
+        {
+            _rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        memcpy(slot, command, length);
+        publish(position, length);
+        return true;
+    }
+
+    /// @brief Post a null-terminated command.
+    bool post(const char* command)
+    {
+        return post(command, strlen(command));
+    }
+
+    /// @brief Post a command stored in PROGMEM.
+    bool post(const __FlashStringHelper* command)
+    {
+        const char* text = reinterpret_cast<const char*>(command);
+        size_t length = strlen_P(text);
+        uint8_t* slot;
+        uint32_t position;
+
+        if (length > _slotSize || !claim(slot, position))
+        {
+            _rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        memcpy_P(slot, text, length);
+        publish(position, length);
+        return true;
+    }
+
+    /**
+     * @brief Post a numeric assignment, encoded in the slot.
+     * @param prefix Command up to the value, in PROGMEM (e.g. F("n0.val=")).
+     * @param value Value appended in decimal.
+     * @return false if the queue is full or the command exceeds the slot size.
+     */
+    bool postValue(const __FlashStringHelper* prefix, int32_t value)
+    {
+        const char* text = reinterpret_cast<const char*>(prefix);
+        size_t length = strlen_P(text);
+        char digits[12];
+        size_t count = format(value, digits);
+        uint8_t* slot;
+        uint32_t position;
+
+        if (length + count > _slotSize || !claim(slot, position))
+        {
+            _rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        memcpy_P(slot, text, length);
+        memcpy(slot + length, digits, count);
+        publish(position, length + count);
+        return true;
+    }
+
+    /**
+     * @brief Access the oldest published command (consumer only).
+     * @param data Receives the command bytes, valid until `pop()`.
+     * @param length Receives the number of bytes.
+     * @return false if the queue is empty.
+     */
+    bool peek(const uint8_t*& data, size_t& length) const
+    {
+        uint32_t position = _dequeue.load(std::memory_order_relaxed);
+        uint32_t index = position & _mask;
+
+        if (_sequences[index].load(std::memory_order_acquire) != position + 1)
+            return false;
+
+        data = _storage + static_cast<size_t>(index) * _slotSize;
+        length = _lengths[index];
+        return true;
+    }
+
+    /// @brief Release the command returned by `peek()` (consumer only).
+    void pop()
+    {
+        uint32_t position = _dequeue.load(std::memory_order_relaxed);
+        _sequences[position & _mask].store(position + _mask + 1, std::memory_order_release);
+        _dequeue.store(position + 1, std::memory_order_release);
+    }
+
+    /// @brief Approximate number of queued commands (any thread).
+    size_t size() const
+    {
+        // Every command the consumer has released was claimed before, so reading its position
+        // first (acquire) keeps the difference from going negative
+        uint32_t dequeued = _dequeue.load(std::memory_order_acquire);
+        uint32_t used = _enqueue.load(std::memory_order_relaxed) - dequeued;
+        return used <= _mask + 1 ? used : _mask + 1;
+    }
+
+    /// @brief Number of slots.
+    size_t capacity() const { return _mask + 1; }
+
+    /// @brief true when the queue is at least three quarters full.
+    bool isCongested() const { return size() * 4 >= capacity() * 3; }
+
+    /// @brief Number of commands accepted.
+    uint32_t postedCount() const { return _posted.load(std::memory_order_relaxed); }
+
+    /// @brief Number of commands rejected (queue full or command too long).
+    uint32_t rejectedCount() const { return _rejected.load(std::memory_order_relaxed); }
+
+protected:
+    NextionCommandQueueBase(std::atomic<uint32_t>* sequences, uint8_t* lengths, uint8_t* storage, size_t slots, size_t slotSize)
+        : _sequences(sequences), _lengths(lengths), _storage(storage), _mask(static_cast<uint32_t>(slots - 1)),
+          _slotSize(slotSize), _enqueue(0), _dequeue(0), _posted(0), _rejected(0) {}
+
+    /// @brief Number the slots; called once the derived storage has been constructed.
+    void initialize()
+    {
+        for (uint32_t i = 0; i <= _mask; i++)
+            _sequences[i].store(i, std::memory_order_relaxed);
+    }
+
+private:
+    /// @brief Reserve the next free slot; false if the queue is full.
+    bool claim(uint8_t*& slot, uint32_t& position)
+    {
+        position = _enqueue.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            uint32_t index = position & _mask;
+            int32_t difference = static_cast<int32_t>(_sequences[index].load(std::memory_order_acquire) - position);
+
+            if (difference == 0)
+            {
+                if (_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot = _storage + static_cast<size_t>(index) * _slotSize;
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = _enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief Make a filled slot visible to the consumer.
+    void publish(uint32_t position, size_t length)
+    {
+        uint32_t index = position & _mask;
+        _lengths[index] = static_cast<uint8_t>(length);
+        _sequences[index].store(position + 1, std::memory_order_release);
+        _posted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static size_t format(int32_t value, char* digits)
+    {
+        char reversed[10];
+        size_t count = 0;
+        size_t used = 0;
+        uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+
+        do
+        {
+            reversed[count++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
+
+        if (value < 0)
+            digits[used++] = '-';
+
+        while (count > 0)
+            digits[used++] = reversed[--count];
+
+        return used;
+    }
+
+    std::atomic<uint32_t>* _sequences;
+    uint8_t* _lengths;
+    uint8_t* _storage;
+    uint32_t _mask;
+    size_t _slotSize;
+    std::atomic<uint32_t> _enqueue;
+    std::atomic<uint32_t> _dequeue;
+    std::atomic<uint32_t> _posted;
+    std::atomic<uint32_t> _rejected;
+};
+
+/**
+ * @class NextionCommandQueue
+ * @brief Command queue with inline storage.
+ *
+ * @tparam Slots Number of commands (power of two).
+ * @tparam SlotSize Longest command in bytes, terminator excluded (at most 255).
+ */
+template <size_t Slots, size_t SlotSize>
+class NextionCommandQueue : public NextionCommandQueueBase {
+    static_assert(Slots >= 2 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+    static_assert(SlotSize <= 255, "SlotSize must fit in a byte");
+
+public:
+    NextionCommandQueue() : NextionCommandQueueBase(_sequenceStorage, _lengthStorage, _slotStorage, Slots, SlotSize)
+    {
+        initialize();
+    }
+
+private:
+    std::atomic<uint32_t> _sequenceStorage[Slots];
+    uint8_t _lengthStorage[Slots];
+    uint8_t _slotStorage[Slots * SlotSize];
+};
+
+#endif
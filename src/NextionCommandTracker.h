@@ -0,0 +1,594 @@
+#pragma once
+
+#include <Arduino.h>
+#include "NextionCircuitBreaker.h"
+#include "NextionHash.h"
+
+/**
+ * @file NextionCommandTracker.h
+ * @brief In-flight command tracking for matching `bkcmd=3` acknowledgements.
+ *
+ * With `bkcmd=3` the display answers every command with a success (0x01) or
+ * error code, in the order the commands were received. A `NextionCommandTracker`
+ * sits between the library and the serial port and records each command as its
+ * terminator goes out:
+ * - a 16-bit FNV-1a hash of the command text,
+ * - its source: a prepared template, a widget, or nothing for raw commands,
+ * - the page that sent it and the time it was sent.
+ *
+ * `NextionControl` pops the oldest record for every ack, so each success or
+ * error is attributed to the exact command that caused it. Failed idempotent
+ * writes (prepared templates and widget values) are retried with exponential
+ * backoff when the error is transient; other failures are reported to the
+ * sending page through `BaseDisplayPage::handleCommandFailure()`.
+ *
+ * Usage:
+ * @code
+ * NextionCommandTracker tracker(&Serial2);
+ * NextionControl nextion(&Serial2, pages, pageCount);
+ *
+ * void setup() {
+ *     nextion.begin();
+ *     nextion.setAckTracking(&tracker);   // sends bkcmd=3
+ * }
+ * @endcode
+ *
+ * An optional `NextionCircuitBreaker` (see NextionCircuitBreaker.h) can be
+ * attached to suppress commands to targets that keep failing.
+ *
+ * RAM: `CommandTrackDepth` records of 12 bytes (AVR: hash, source, page,
+ * target and sentAt of 2 bytes each, kind and attempts of 1) plus retry slots.
+ */
+
+class BaseDisplayPage;
+
+/// Number of commands that can await an acknowledgement at once.
+const uint8_t CommandTrackDepth = 8;
+
+/// Number of failed commands that can wait for a retry at once.
+const uint8_t CommandRetrySlots = 4;
+
+/// Time (ms) after which an unacknowledged command is treated as lost.
+const uint16_t CommandAckTimeout = 500;
+
+/// Maximum number of retries of a failed idempotent write.
+const uint8_t CommandMaxRetries = 3;
+
+/// Delay (ms) before the first retry; doubled for each further attempt.
+const uint16_t CommandRetryBackoff = 50;
+
+/// Maximum number of leading command bytes held while a circuit breaker decides on them.
+const uint8_t CommandHoldLength = 24;
+
+/// Response code reported for a command whose acknowledgement never arrived.
+const uint8_t CommandTimeoutCode = 0xFF;
+
+/**
+ * @struct NextionCommandRecord
+ * @brief Identity of one command sent to the display.
+ */
+struct NextionCommandRecord {
+    /// @brief Origin of a command.
+    enum Kind : uint8_t {
+        /// Raw command; identified by its hash only.
+        KindRaw = 0,
+        /// Query answered with data instead of 0x01 (`get`, `sendme`).
+        KindQuery = 1,
+        /// Prepared template; `source` is the `NextionPreparedCommandBase`.
+        KindPrepared = 2,
+        /// Widget value; `source` is the `NextionWidget`.
+        KindWidget = 3
+    };
+
+    /// @brief Folded FNV-1a hash of the command text, terminator excluded.
+    uint16_t hash;
+
+    /// @brief Prepared template or widget that produced the command, or nullptr.
+    const void* source;
+
+    /// @brief Page that sent the command, or the active page for commands without a known sender.
+    BaseDisplayPage* page;
+
+    /// @brief Folded FNV-1a hash of the component path (`n0` for `n0.val=5`).
+    uint16_t target;
+
+    /// @brief Low 16 bits of `millis()` when the terminator was written.
+    uint16_t sentAt;
+
+    /// @brief One of `Kind`.
+    uint8_t kind;
+
+    /// @brief Number of retries already made (0 for the first send).
+    uint8_t attempts;
+
+    /// @brief true if the command can be re-sent safely (prepared templates and widgets).
+    bool isIdempotent() const { return kind == KindPrepared || kind == KindWidget; }
+};
+
+/**
+ * @class NextionCommandTracker
+ * @brief Stream wrapper recording commands in send order.
+ *
+ * All reads and writes pass straight through to the wrapped port. Writes are
+ * hashed on the way out and a record is pushed when the 0xFF 0xFF 0xFF
+ * terminator is seen, so commands are tracked no matter which helper sent them.
+ */
+class NextionCommandTracker : public Stream {
+public:
+    /**
+     * @brief Construct a tracker around the port connected to the display.
+     * @param port Serial port; must outlive the tracker.
+     */
+    explicit NextionCommandTracker(Stream* port)
+        : _port(port), _head(0), _count(0), _skipAcks(0), _untracked(0),
+          _breaker(nullptr), _activePage(nullptr),
+          _hash(HashSeed), _pathHash(HashSeed), _dotHash(HashSeed), _target(0),
+          _terminatorCount(0), _length(0), _heldLength(0),
+          _hasDot(false), _targetKnown(false), _holding(false), _dropping(false),
+          _source(nullptr), _page(nullptr), _kind(NextionCommandRecord::KindRaw), _attempts(0)
+    {
+        clear();
+    }
+
+    /// @brief Get the wrapped port.
+    Stream* getPort() const { return _port; }
+
+    int available() override { return _port->available(); }
+    int read() override { return _port->read(); }
+    int peek() override { return _port->peek(); }
+    int availableForWrite() override { return _port->availableForWrite(); }
+    void flush() override { _port->flush(); }
+
+    size_t write(uint8_t value) override
+    {
+        return write(&value, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override
+    {
+        if (!_breaker)
+        {
+            for (size_t i = 0; i < size; i++)
+                track(buffer[i]);
+
+            return _port->write(buffer, size);
+        }
+
+        // Runs of bytes for commands already let through are forwarded straight from `buffer`
+        size_t run = 0;
+
+        for (size_t i = 0; i < size; i++)
+        {
+            if (_holding || _dropping)
+            {
+                gate(buffer[i]);
+                run = i + 1;
+                continue;
+            }
+
+            track(buffer[i]);
+
+            // Command complete: the next one is held until its target is known
+            if (_holding)
+            {
+                _port->write(buffer + run, i + 1 - run);
+                run = i + 1;
+            }
+        }
+
+        if (run < size)
+            _port->write(buffer + run, size - run);
+
+        return size;
+    }
+
+    using Print::write;
+
+    /**
+     * @brief Attach a circuit breaker suppressing commands to failing targets.
+     *
+     * While attached, the first bytes of each command are held (at most
+     * `CommandHoldLength`) until its target is known, then forwarded in one
+     * write or dropped.
+     *
+     * @param breaker Circuit breaker, or nullptr to detach.
+     */
+    void setCircuitBreaker(NextionCircuitBreaker* breaker)
+    {
+        _breaker = breaker;
+        _holding = _breaker != nullptr && _length == 0 && _terminatorCount == 0;
+    }
+
+    /// @brief Get the attached circuit breaker, or nullptr.
+    NextionCircuitBreaker* getCircuitBreaker() const { return _breaker; }
+
+    /**
+     * @brief Set the page active on the display (called by NextionControl on page changes).
+     * @param page Active page; keys raw commands for the circuit breaker.
+     */
+    void setActivePage(BaseDisplayPage* page) { _activePage = page; }
+
+    /**
+     * @brief Feed the outcome of an acknowledged command to the circuit breaker.
+     * @param record Command the acknowledgement belongs to.
+     * @param responseCode 0x01 for success, otherwise the error code.
+     * @param now Current time in milliseconds.
+     */
+    void recordOutcome(const NextionCommandRecord& record, uint8_t responseCode, unsigned long now)
+    {
+        if (!_breaker)
+            return;
+
+        if (responseCode == 0x01)
+            _breaker->recordSuccess(record.page, record.target);
+        else if (responseCode == 0x02 || responseCode == 0x1A)
+            _breaker->recordFailure(record.page, record.target, now);
+    }
+
+    /**
+     * @brief Attribute the next command to a prepared template or widget.
+     *
+     * Consumed by the next terminator written.
+     *
+     * @param kind Record kind (`KindPrepared` or `KindWidget`).
+     * @param source Template or widget producing the command.
+     * @param page Sending page, or nullptr for the controller.
+     */
+    void setSource(uint8_t kind, const void* source, BaseDisplayPage* page)
+    {
+        _kind = kind;
+        _source = source;
+        _page = page;
+    }
+
+    /**
+     * @brief Set the retry count carried by the next command (used when re-sending).
+     * @param attempts Number of retries already made.
+     */
+    void setAttempts(uint8_t attempts) { _attempts = attempts; }
+
+    /// @brief Discard a source or retry count that was set but not used by a command.
+    void cancelSource()
+    {
+        setSource(NextionCommandRecord::KindRaw, nullptr, nullptr);
+        _attempts = 0;
+    }
+
+    /**
+     * @brief Remove the oldest in-flight command, matching it to an acknowledgement.
+     * @param record Receives the command the acknowledgement belongs to.
+     * @return false if nothing is in flight, or the ack belongs to an untracked command.
+     */
+    bool pop(NextionCommandRecord& record)
+    {
+        if (_skipAcks > 0)
+        {
+            _skipAcks--;
+            return false;
+        }
+
+        if (_count == 0)
+            return false;
+
+        record = _records[_head];
+        _head = (_head + 1) % CommandTrackDepth;
+        _count--;
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest in-flight command if it is a query.
+     *
+     * Queries are answered with data (0x66, 0x70, 0x71) rather than 0x01.
+     *
+     * @return true if a query was removed.
+     */
+    bool popQuery()
+    {
+        if (_skipAcks > 0 || _count == 0 || _records[_head].kind != NextionCommandRecord::KindQuery)
+            return false;
+
+        NextionCommandRecord record;
+        return pop(record);
+    }
+
+    /**
+     * @brief Remove the oldest in-flight command if it has waited longer than `CommandAckTimeout`.
+     * @param now Current time in milliseconds.
+     * @param record Receives the expired command.
+     * @return true if a command expired.
+     */
+    bool popExpired(unsigned long now, NextionCommandRecord& record)
+    {
+        if (_count == 0 || static_cast<uint16_t>(static_cast<uint16_t>(now) - _records[_head].sentAt) < CommandAckTimeout)
+            return false;
+
+        // Acks still owed to dropped records can no longer be told apart from a late one
+        _skipAcks = 0;
+        return pop(record);
+    }
+
+    /**
+     * @brief Queue a failed command for retry after an exponential backoff.
+     * @param record Failed command.
+     * @param now Current time in milliseconds.
+     * @return false if no retry slot is free. true if queued, or if a retry of
+     *         the same source was already queued.
+     */
+    bool scheduleRetry(const NextionCommandRecord& record, unsigned long now)
+    {
+        // A retry re-sends the source's latest value, so one queued retry per source is enough
+        for (uint8_t i = 0; i < CommandRetrySlots; i++)
+        {
+            if (_retries[i].source == record.source)
+                return true;
+        }
+
+        for (uint8_t i = 0; i < CommandRetrySlots; i++)
+        {
+            if (_retries[i].source)
+                continue;
+
+            _retries[i] = record;
+            _retries[i].sentAt = static_cast<uint16_t>(now + (static_cast<uint32_t>(CommandRetryBackoff) << record.attempts));
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Take a queued retry whose backoff has elapsed.
+     * @param now Current time in milliseconds.
+     * @param record Receives the command to re-send (`attempts` not yet incremented).
+     * @return true if a retry is due.
+     */
+    bool popDueRetry(unsigned long now, NextionCommandRecord& record)
+    {
+        for (uint8_t i = 0; i < CommandRetrySlots; i++)
+        {
+            if (!_retries[i].source || static_cast<int16_t>(static_cast<uint16_t>(now) - _retries[i].sentAt) < 0)
+                continue;
+
+            record = _retries[i];
+            _retries[i].source = nullptr;
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Time the oldest command expires or the next retry is due.
+     * @param now Current time in milliseconds.
+     * @param due Receives the time in milliseconds.
+     * @return false if nothing is in flight or queued for retry.
+     */
+    bool nextDeadline(unsigned long now, unsigned long& due) const
+    {
+        bool found = false;
+        long wait = 0;
+
+        if (_count > 0)
+        {
+            uint16_t elapsed = static_cast<uint16_t>(static_cast<uint16_t>(now) - _records[_head].sentAt);
+            wait = elapsed < CommandAckTimeout ? static_cast<long>(CommandAckTimeout - elapsed) : 0;
+            found = true;
+        }
+
+        for (uint8_t i = 0; i < CommandRetrySlots; i++)
+        {
+            if (!_retries[i].source)
+                continue;
+
+            long retry = static_cast<int16_t>(_retries[i].sentAt - static_cast<uint16_t>(now));
+            if (retry < 0)
+                retry = 0;
+
+            if (!found || retry < wait)
+                wait = retry;
+
+            found = true;
+        }
+
+        due = now + static_cast<unsigned long>(wait);
+        return found;
+    }
+
+    /// @brief Forget every in-flight command and queued retry (e.g. after a display restart).
+    void clear()
+    {
+        _head = 0;
+        _count = 0;
+        _skipAcks = 0;
+
+        for (uint8_t i = 0; i < CommandRetrySlots; i++)
+            _retries[i].source = nullptr;
+    }
+
+    /// @brief Number of commands awaiting an acknowledgement.
+    uint8_t inFlight() const { return _count; }
+
+    /// @brief Number of commands dropped from tracking because the ring was full.
+    uint16_t untrackedCount() const { return _untracked; }
+
+    /**
+     * @brief Hash a command the way the tracker does, for comparing with `NextionCommandRecord::hash`.
+     * @param command Command text without terminator.
+     */
+    static uint16_t hash(const char* command)
+    {
+        size_t length;
+        return NextionHash::fold(NextionHash::text(command, length));
+    }
+
+private:
+    /// @brief Number of leading command bytes kept to recognise queries.
+    static const uint8_t PrefixLength = 6;
+
+    /// @brief Route one byte while the current command is held or being dropped.
+    void gate(uint8_t value)
+    {
+        if (_dropping)
+        {
+            track(value);
+            return;
+        }
+
+        _held[_heldLength++] = value;
+        track(value);
+
+        if (_holding && _heldLength == CommandHoldLength)
+            decide();
+    }
+
+    /// @brief Let the held command through or drop it, once its target is known.
+    void decide()
+    {
+        _holding = false;
+        _dropping = !_breaker->allow(_page ? _page : _activePage, target(), millis());
+
+        if (!_dropping && _heldLength > 0)
+            _port->write(_held, _heldLength);
+
+        _heldLength = 0;
+    }
+
+    /// @brief Folded hash of the component path: everything before the last '.' preceding '=' or ','.
+    uint16_t target()
+    {
+        if (!_targetKnown)
+        {
+            _target = NextionHash::fold(_hasDot ? _dotHash : _pathHash);
+            _targetKnown = true;
+        }
+
+        return _target;
+    }
+
+    /// @brief Hash one outgoing byte and record the command when its terminator completes.
+    void track(uint8_t value)
+    {
+        if (value == 0xFF)
+        {
+            if (++_terminatorCount == 3)
+                record();
+
+            return;
+        }
+
+        // A lone 0xFF inside a command is part of its text
+        while (_terminatorCount > 0)
+        {
+            _hash = NextionHash::update(_hash, 0xFF);
+            _terminatorCount--;
+        }
+
+        if (!_targetKnown)
+        {
+            if (value == '=' || value == ',')
+            {
+                target();
+
+                if (_holding)
+                    decide();
+            }
+            else
+            {
+                if (value == '.')
+                {
+                    _dotHash = _pathHash;
+                    _hasDot = true;
+                }
+
+                _pathHash = NextionHash::update(_pathHash, value);
+            }
+        }
+
+        if (_length < PrefixLength)
+            _prefix[_length] = static_cast<char>(value);
+
+        if (_length < 0xFF)
+            _length++;
+
+        _hash = NextionHash::update(_hash, value);
+    }
+
+    /// @brief Push the command just terminated onto the ring.
+    void record()
+    {
+        if (_holding)
+            decide();
+
+        if (_length > 0 && !_dropping)
+        {
+            if (_count == CommandTrackDepth)
+            {
+                // Drop the oldest; its ack must still be consumed to keep FIFO order
+                _head = (_head + 1) % CommandTrackDepth;
+                _count--;
+                _skipAcks++;
+                _untracked++;
+            }
+
+            NextionCommandRecord& entry = _records[(_head + _count) % CommandTrackDepth];
+            entry.hash = NextionHash::fold(_hash);
+            entry.source = _source;
+            entry.page = _page ? _page : _activePage;
+            entry.target = target();
+            entry.sentAt = static_cast<uint16_t>(millis());
+            entry.kind = isQuery() ? static_cast<uint8_t>(NextionCommandRecord::KindQuery) : _kind;
+            entry.attempts = _attempts;
+            _count++;
+        }
+
+        _hash = HashSeed;
+        _pathHash = HashSeed;
+        _hasDot = false;
+        _targetKnown = false;
+        _terminatorCount = 0;
+        _length = 0;
+        _dropping = false;
+        _holding = _breaker != nullptr;
+        cancelSource();
+    }
+
+    /// @brief true if the command just terminated is answered with data instead of 0x01.
+    bool isQuery() const
+    {
+        if (_length >= 4 && memcmp(_prefix, "get ", 4) == 0)
+            return true;
+
+        return _length == PrefixLength && memcmp(_prefix, "sendme", PrefixLength) == 0;
+    }
+
+    Stream* _port;
+    NextionCommandRecord _records[CommandTrackDepth];
+    NextionCommandRecord _retries[CommandRetrySlots];
+    uint8_t _head;
+    uint8_t _count;
+    uint8_t _skipAcks;
+    uint16_t _untracked;
+
+    NextionCircuitBreaker* _breaker;
+    BaseDisplayPage* _activePage;
+
+    // State of the command currently being written
+    uint32_t _hash;
+    uint32_t _pathHash;
+    uint32_t _dotHash;
+    uint16_t _target;
+    uint8_t _terminatorCount;
+    uint8_t _length;
+    uint8_t _heldLength;
+    bool _hasDot;
+    bool _targetKnown;
+    bool _holding;
+    bool _dropping;
+    char _prefix[PrefixLength];
+    uint8_t _held[CommandHoldLength];
+    const void* _source;
+    BaseDisplayPage* _page;
+    uint8_t _kind;
+    uint8_t _attempts;
+};
@@ -3,7 +3,9 @@
 NextionControl::NextionControl(Stream* serialPort, BaseDisplayPage** pageArray, size_t count)
     : nextionSerialPort(serialPort),
       pageCount(count),
+#ifndef NEXTION_NO_HEAP
       pages(new BaseDisplayPage*[count]),
+#endif
       currPage(0),
       refreshTimer(0),
       currentPage(nullptr)
@@ -11,6 +13,17 @@ NextionControl::NextionControl(Stream* serialPort, BaseDisplayPage** pageArray,
     nextionSerialPort = serialPort;
     pageCount = count;
 
+#ifdef NEXTION_NO_HEAP
+    // Reported by begin() and getDroppedPageCount() rather than ignored
+    if (pageCount > NEXTION_MAX_PAGES)
+    {
+        _droppedPages = pageCount - NEXTION_MAX_PAGES;
+        pageCount = NEXTION_MAX_PAGES;
+    }
+#endif
+
+    _parser.setReturnFraming(true);
+
     for (size_t i = 0; i < pageCount; i++)
     {
         pages[i] = pageArray[i];
@@ -23,10 +36,18 @@ NextionControl::NextionControl(Stream* serialPort, BaseDisplayPage** pageArray,
     }
 }
 
+NextionControl::NextionControl(NextionBufferedStream* serialPort, BaseDisplayPage** pageArray, size_t count)
+    : NextionControl(static_cast<Stream*>(serialPort), pageArray, count)
+{
+    _bufferedPort = serialPort;
+}
+
 NextionControl::~NextionControl()
 {
+#ifndef NEXTION_NO_HEAP
     delete[] pages;
     pages = nullptr;
+#endif
 }
 
 #ifdef NEXTION_DEBUG
@@ -63,110 +84,643 @@ bool NextionControl::begin()
 #ifdef NEXTION_DEBUG
     debugLog(String(F("NextionControl initialized. Waiting for Nextion page events...")));
 #endif
-    return true;
+    return _droppedPages == 0;
 }
 
 void NextionControl::update(unsigned long now)
 {
+#ifdef NEXTION_HEAP_GUARD
+    NextionHeapGuard::Scope heapGuard;
+#endif
+
     readSerial(now);
+
+    // Fall back to restoring state if the display never reported ready
+    if (_resetPending && (now - _resetTime) >= DisplayReadyTimeout)
+        restoreDisplayState(now);
+
+    checkLink(now);
+
+    if (_touchPending)
+        flushTouch(now, false);
+
+    if (_touchTimer)
+    {
+        NextionTouchEvent event;
+
+        while (_touchTimer->poll(now, event))
+            deliverTouchEvent(event);
+    }
+
+    if (_gestures)
+    {
+        NextionGesture gesture;
+
+        while (_gestures->poll(now, gesture))
+        {
+            if (currentPage)
+                currentPage->handleGesture(gesture);
+        }
+    }
+
+    if (_frameListener)
+        _frameListener->onUpdate(now);
+
+    // Nothing reaches a lost display; widget values stay pending until it is back
+    if (_linkState == LinkLost)
+        return;
+
+#ifdef NEXTION_COMMAND_QUEUE
+    if (_commandQueue)
+    {
+        const uint8_t* data;
+        size_t length;
+
+        for (uint8_t i = 0; i < CommandQueueDrainLimit && _commandQueue->peek(data, length); i++)
+        {
+            sendCommand(reinterpret_cast<const char*>(data), length);
+            _commandQueue->pop();
+        }
+    }
+#endif
+
+    if (_tracker)
+    {
+        NextionCommandRecord command;
+
+        while (_tracker->popExpired(now, command))
+            handleCommandFailure(command, CommandTimeoutCode, now);
+
+        while (_tracker->popDueRetry(now, command))
+            retryCommand(command, now);
+    }
     
     // Optional periodic updates (for other text fields, numbers, etc.)
     if (currentPage && (now - refreshTimer) > RefreshTime)
     {
         currentPage->refresh(now);
+        currentPage->flushWidgets(now);
         refreshTimer = now;
     }
+    else if (currentPage && currentPage->_widgetsPending)
+    {
+        // Send rate-limited widget values as soon as their window opens
+        currentPage->flushWidgets(now);
+    }
+    else if (pageCount > 1 && (now - _backgroundTimer) >= BackgroundFlushTime)
+    {
+        // Low priority: keep global components of inactive pages current
+        flushBackgroundPage(now);
+        _backgroundTimer = now;
+    }
 }
 
-void NextionControl::sendCommand(const String& cmd)
+unsigned long NextionControl::nextDeadline(unsigned long now) const
 {
-#ifdef NEXTION_DEBUG
-    debugLog(String(F("Sending Command:")) + cmd);
+    // The periodic refresh bounds every wait
+    unsigned long due = now + RefreshTime;
+    unsigned long candidate;
+
+    // update() skips refreshes, flushes, retries and the queue while the link is lost,
+    // so their deadlines would stay in the past and the caller would never sleep
+    bool lost = _linkState == LinkLost;
+
+    if (!lost)
+    {
+        if (currentPage)
+            keepEarlier(due, refreshTimer + RefreshTime + 1);
+
+        if (currentPage && currentPage->_widgetsPending)
+            keepEarlier(due, now + UpdatePollInterval);
+        else if (pageCount > 1)
+            keepEarlier(due, _backgroundTimer + BackgroundFlushTime);
+    }
+
+    if (_parser.isReceiving())
+        keepEarlier(due, _lastCharTime + SerialTimeout + 1);
+
+    if (_resetPending)
+        keepEarlier(due, _resetTime + DisplayReadyTimeout);
+
+    if (_heartbeatInterval > 0 && _linkState != LinkSleeping)
+    {
+        unsigned long replyTimeout = _heartbeatInterval < LinkReplyTimeout ? _heartbeatInterval : LinkReplyTimeout;
+
+        if (_heartbeatMisses >= LinkMaxMisses && _linkState != LinkLost)
+            keepEarlier(due, _heartbeatTime + replyTimeout);
+
+        // The next heartbeat waits for both a quiet link and the previous heartbeat's interval
+        candidate = _lastFrameTime + _heartbeatInterval;
+        if (_heartbeats > 0 && static_cast<long>(_heartbeatTime + _heartbeatInterval - candidate) > 0)
+            candidate = _heartbeatTime + _heartbeatInterval;
+
+        keepEarlier(due, candidate);
+    }
+
+    if (_pageUncertain && !lost)
+        keepEarlier(due, _pageRequests > 0 ? _resyncRequestTime + _resyncBackoff : now);
+
+    if (_touchPending)
+        keepEarlier(due, _lastTouchTime + _touchMinInterval);
+
+    if (_touchTimer && _touchTimer->nextDeadline(candidate))
+        keepEarlier(due, candidate);
+
+    if (_gestures && _gestures->nextDeadline(candidate))
+        keepEarlier(due, candidate);
+
+    if (_tracker && !lost && _tracker->nextDeadline(now, candidate))
+        keepEarlier(due, candidate);
+
+    if (_frameListener && _frameListener->nextDeadline(candidate))
+        keepEarlier(due, candidate);
+
+#ifdef NEXTION_COMMAND_QUEUE
+    if (_commandQueue && !lost && _commandQueue->size() > 0)
+        keepEarlier(due, now);
 #endif
-    nextionSerialPort->print(cmd);
-    nextionSerialPort->write(0xFF);
-    nextionSerialPort->write(0xFF);
-    nextionSerialPort->write(0xFF);
+
+    return due;
 }
 
-void NextionControl::readSerial(unsigned long now)
+void NextionControl::keepEarlier(unsigned long& due, unsigned long candidate)
 {
-    while (nextionSerialPort->available() > 0)
-    {
-        uint8_t b = nextionSerialPort->read();
-        
+    if (static_cast<long>(candidate - due) < 0)
+        due = candidate;
+}
+
+void NextionControl::sendCommand(const char* cmd)
+{
+    if (!cmd)
+        return;
+
+    sendCommand(cmd, strlen(cmd));
+}
+
+void NextionControl::sendCommand(const __FlashStringHelper* cmd)
+{
+    if (!cmd)
+        return;
+
 #ifdef NEXTION_DEBUG
-        debugLog(String(F("RX: 0x")) + String(b, HEX) + String(F(" (START of message)")));
+    debugLog(String(F("Sending Command:")) + String(cmd));
 #endif
-        
-        _lastCharTime = millis();
+    NextionFlash::write(nextionSerialPort, cmd);
+    endCommand();
+}
 
-        if (!_readingMessage)
-        {
-            _terminatorCount = 0;
+void NextionControl::sendCommand(const char* cmd, size_t length)
+{
+    if (!cmd)
+        return;
 
-            // Skip leading 0xFF bytes (these are just noise/incomplete terminators)
-            if (b == 0xFF) {
 #ifdef NEXTION_DEBUG
-                debugLog(String(F("RX: 0x")) + String(b, HEX) + String(F(" (skipped - leading 0xFF)")));
+    String debugCmd(F("Sending Command:"));
+    for (size_t i = 0; i < length; i++)
+        debugCmd += cmd[i];
+    debugLog(debugCmd);
 #endif
-                continue;
-            }
+    nextionSerialPort->write(reinterpret_cast<const uint8_t*>(cmd), length);
+    endCommand();
+}
+
+void NextionControl::sendPrepared(NextionPreparedCommandBase& command, int32_t value)
+{
+    size_t length = command.format(value);
+    if (length == 0)
+        return;
+
+    if (_tracker)
+        _tracker->setSource(NextionCommandRecord::KindPrepared, &command, nullptr);
+
+    nextionSerialPort->write(command.data(), length);
+}
+
+void NextionControl::sendPrepared(NextionPreparedCommandBase& command, const char* text)
+{
+    size_t length = command.format(text);
+    if (length == 0)
+        return;
+
+    if (_tracker)
+        _tracker->setSource(NextionCommandRecord::KindPrepared, &command, nullptr);
+
+    nextionSerialPort->write(command.data(), length);
+}
+
+void NextionControl::setTouchCoalescing(bool enabled, uint16_t minDistance, uint16_t minInterval)
+{
+    if (!enabled && _touchPending)
+        flushTouch(millis(), true);
+
+    _touchCoalesce = enabled;
+    _touchMinDistance = minDistance;
+    _touchMinInterval = minInterval;
+}
+
+void NextionControl::coalesceTouch(uint16_t x, uint16_t y, uint8_t eventType)
+{
+    bool pressed = eventType == EventPress;
+
+    if (pressed && _touchDown)
+    {
+        // Movement while down: keep only the newest point until update()
+        if (_touchPending)
+            _touchDropped++;
+
+        _touchX = x;
+        _touchY = y;
+        _touchPending = true;
+        return;
+    }
+
+    // Press and release transitions are delivered at once, after the last movement
+    unsigned long now = millis();
+
+    if (_touchPending)
+        flushTouch(now, true);
+
+    _touchDown = pressed;
+    deliverTouch(x, y, eventType, now);
+}
+
+void NextionControl::flushTouch(unsigned long now, bool force)
+{
+    if (!force && _touchMinInterval > 0 && (now - _lastTouchTime) < _touchMinInterval)
+        return;
+
+    _touchPending = false;
+
+    if (_touchMinDistance > 0)
+    {
+        int32_t dx = static_cast<int32_t>(_touchX) - _lastTouchX;
+        int32_t dy = static_cast<int32_t>(_touchY) - _lastTouchY;
+        int32_t minDistance = _touchMinDistance;
+
+        if (dx * dx + dy * dy < minDistance * minDistance)
+        {
+            _touchDropped++;
+            return;
+        }
+    }
+
+    deliverTouch(_touchX, _touchY, EventPress, now);
+}
+
+void NextionControl::deliverTouch(uint16_t x, uint16_t y, uint8_t eventType, unsigned long now)
+{
+    _lastTouchX = x;
+    _lastTouchY = y;
+    _lastTouchTime = now;
+
+    if (_gestures)
+    {
+        NextionGesture gesture;
+
+        if (_gestures->feed(x, y, eventType, now, gesture) && currentPage)
+            currentPage->handleGesture(gesture);
+    }
+    else if (currentPage)
+    {
+        currentPage->handleTouchXY(x, y, eventType);
+    }
+}
+
+void NextionControl::setTouchTimer(NextionTouchTimer* timer)
+{
+    _touchTimer = timer;
+
+    if (_touchTimer)
+        _touchTimer->cancel();
+}
+
+void NextionControl::deliverTouchEvent(const NextionTouchEvent& event)
+{
+    if (currentPage && currentPage->getPageId() == event.page)
+        currentPage->handleTouchEvent(event);
+}
+
+void NextionControl::setGestureRecognizer(NextionGestureRecognizer* recognizer)
+{
+    _gestures = recognizer;
+
+    if (_gestures)
+        _gestures->reset();
+}
+
+void NextionControl::setAckTracking(NextionCommandTracker* tracker)
+{
+    Stream* port = _tracker ? _tracker->getPort() : nextionSerialPort;
+
+    _tracker = tracker;
+    if (_tracker)
+    {
+        _tracker->clear();
+        _tracker->setActivePage(currentPage);
+    }
+
+    // Route every page through the tracker so all commands are recorded in send order
+    nextionSerialPort = _tracker ? static_cast<Stream*>(_tracker) : port;
+
+    for (size_t i = 0; i < pageCount; i++)
+    {
+        if (!pages[i])
+            continue;
+
+        pages[i]->nextionSerialPort = nextionSerialPort;
+        pages[i]->_tracker = _tracker;
+    }
+
+    sendCommand(_tracker ? F("bkcmd=3") : F("bkcmd=2"));
+}
+
+void NextionControl::handleCommandFailure(const NextionCommandRecord& command, uint8_t responseCode, unsigned long now)
+{
+    // 0x00 usually means the command was garbled on the wire; a timeout that it was lost
+    bool transient = responseCode == 0x00 || responseCode == CommandTimeoutCode;
+
+    if (transient && command.isIdempotent() && command.attempts < CommandMaxRetries &&
+        _tracker->scheduleRetry(command, now))
+        return;
 
-            _readingMessage = true;
-            _serialBufferPos = 0;
 #ifdef NEXTION_DEBUG
-            debugLog(String(F("RX: 0x")) + String(b, HEX) + String(F(" (START of message)")));
+    debugLog(String(F("  -> Command failed: hash=0x")) + String(command.hash, HEX) + String(F(" code=0x")) + String(responseCode, HEX) +
+        String(F(" attempts=")) + String(command.attempts));
 #endif
-        }
 
-        if (_serialBufferPos < SerialBufferSize)
+    BaseDisplayPage* page = command.page ? command.page : currentPage;
+    if (page)
+        page->handleCommandFailure(command, responseCode);
+}
+
+void NextionControl::retryCommand(const NextionCommandRecord& command, unsigned long now)
+{
+    uint8_t attempts = command.attempts + 1;
+
+    if (command.kind == NextionCommandRecord::KindWidget)
+    {
+        if (command.page)
+            command.page->retryWidget(static_cast<NextionWidget*>(const_cast<void*>(command.source)), attempts, now);
+
+        return;
+    }
+
+    // Component state is reset when its page is left, so a stale write is pointless
+    if (command.page && !command.page->_isActive)
+        return;
+
+    // The template holds its latest value; re-sending it is always safe
+    const NextionPreparedCommandBase* prepared = static_cast<const NextionPreparedCommandBase*>(command.source);
+    if (prepared->length() == 0)
+        return;
+
+    _tracker->setSource(NextionCommandRecord::KindPrepared, prepared, command.page);
+    _tracker->setAttempts(attempts);
+    nextionSerialPort->write(prepared->data(), prepared->length());
+}
+
+void NextionControl::endCommand()
+{
+    static const uint8_t terminator[3] = { 0xFF, 0xFF, 0xFF };
+    nextionSerialPort->write(terminator, sizeof(terminator));
+}
+
+void NextionControl::readSerial(unsigned long now)
+{
+    uint32_t discarded = _parser.discardedCount();
+
+    if (_bufferedPort)
+    {
+        const uint8_t* data;
+        size_t length;
+
+        // Parse straight from the port's buffer, one block per device read
+        while ((length = _bufferedPort->receiveBlock(data)) > 0)
         {
-            _serialBuffer[_serialBufferPos++] = b;
+            size_t used = 0;
+            bool overflow = false;
+
+            _lastCharTime = millis();
+
+            while (used < length && !overflow)
+                overflow = !receiveByte(data[used++]);
+
+            _bufferedPort->consumeBlock(used);
+
+            if (overflow)
+                break;
         }
-        else
+    }
+    else
+    {
+        while (nextionSerialPort->available() > 0)
         {
+            uint8_t b = nextionSerialPort->read();
+            _lastCharTime = millis();
+
+            if (!receiveByte(b))
+                break;
+        }
+    }
+
+    // Noise skipped while resynchronising may have hidden a page report
+    if (_parser.discardedCount() != discarded)
+        _pageUncertain = true;
+
+    // Timeout handling for incomplete messages
+    if (_parser.isReceiving() && (now - _lastCharTime > SerialTimeout))
+    {
+        uint8_t header = _parser.header();
+
 #ifdef NEXTION_DEBUG
-            debugLog(String(F("ERROR: Serial buffer overflow!")));
+        debugLog(String(F("TIMEOUT: Abandoning incomplete message (")) + String(_parser.received()) + String(F(" bytes received)")));
 #endif
-            _readingMessage = false;
-            _serialBufferPos = 0;
-            _terminatorCount = 0;
-            break;
-        }
 
-        if (b == 0xFF)
-            _terminatorCount++;
-        else
-            _terminatorCount = 0;
+        // A complete fixed-length payload only missed its terminator
+        if (_parser.expire() == NextionParserBase::Frame)
+            handleNextionMessage(_parser.frame(), _parser.length());
+        else if (affectsPage(header))
+            _pageUncertain = true;
+    }
 
-        if (_terminatorCount >= 3)
-        {
-            size_t msgLen = _serialBufferPos - 3; // exclude terminator
-            
+    resyncPage(now);
+}
+
+bool NextionControl::receiveByte(uint8_t b)
+{
 #ifdef NEXTION_DEBUG
-            debugLog(String(F("Complete message assembled: ")) + String(msgLen) + String(F(" bytes")));
+    debugLog(String(F("RX: 0x")) + String(b, HEX));
 #endif
-            
-            handleNextionMessage(_serialBuffer, msgLen);
-            
-            _serialBufferPos = 0;
-            _terminatorCount = 0;
-            _readingMessage = false;
-        }
+
+    NextionParserBase::Result result = _parser.feed(b);
+
+    if (result == NextionParserBase::Skipped)
+    {
+#ifdef NEXTION_DEBUG
+        debugLog(String(F("RX: 0x")) + String(b, HEX) + String(F(" (skipped - leading 0xFF)")));
+#endif
+        return true;
     }
 
-    // Timeout handling for incomplete messages
-    if (_readingMessage && (now - _lastCharTime > SerialTimeout))
+    if (result == NextionParserBase::Overflow)
+    {
+#ifdef NEXTION_DEBUG
+        debugLog(String(F("ERROR: Serial buffer overflow!")));
+#endif
+        _pageUncertain = true;
+        return false;
+    }
+
+#ifdef NEXTION_DEBUG
+    if (result == NextionParserBase::Pending && _parser.received() == 1)
+        debugLog(String(F("RX: 0x")) + String(b, HEX) + String(F(" (START of message)")));
+#endif
+
+    if (result == NextionParserBase::Frame)
     {
 #ifdef NEXTION_DEBUG
-        debugLog(String(F("TIMEOUT: Abandoning incomplete message (")) + String(_serialBufferPos) + String(F(" bytes received)")));
+        debugLog(String(F("Complete message assembled: ")) + String(_parser.length()) + String(F(" bytes")));
+#endif
+
+        handleNextionMessage(_parser.frame(), _parser.length());
+    }
+
+    return true;
+}
+
+bool NextionControl::affectsPage(uint8_t header)
+{
+    // Touch events and page reports carry page state; an unrecognisable header may be either
+    return header == 0x00 || header == 0x65 || header == 0x66 || header == 0x87 || header == 0x88 ||
+        NextionParserBase::returnLength(header) == NextionParserBase::InvalidHeader;
+}
+
+void NextionControl::resyncPage(unsigned long now)
+{
+    if (!_pageUncertain)
+        return;
+
+    unsigned long elapsed = now - _resyncRequestTime;
+
+    // After a quiet period the first request is immediate again
+    if (elapsed >= ResyncBackoffMax)
+        _resyncBackoff = 0;
+
+    if (_pageRequests > 0 && elapsed < _resyncBackoff)
+        return;
+
+#ifdef NEXTION_DEBUG
+    debugLog(String(F("RESYNC: Page uncertain, requesting current page (backoff ")) + String(_resyncBackoff) + String(F(" ms)")));
+#endif
+
+    _pageUncertain = false;
+    _resyncRequestTime = now;
+    _resyncBackoff = _resyncBackoff == 0 ? ResyncBackoffMin :
+        (_resyncBackoff * 2 < ResyncBackoffMax ? _resyncBackoff * 2 : ResyncBackoffMax);
+    _pageRequests++;
+    requestCurrentPage();
+}
+
+NextionLinkStats NextionControl::getLinkStats() const
+{
+    NextionLinkStats stats;
+    stats.resyncs = _parser.resyncCount();
+    stats.discardedBytes = _parser.discardedCount();
+    stats.pageRequests = _pageRequests;
+    stats.heartbeats = _heartbeats;
+    stats.stateChanges = _linkStateChanges;
+    stats.losses = _linkLosses;
+    stats.state = _linkState;
+    return stats;
+}
+
+void NextionControl::setHeartbeat(unsigned long interval, const __FlashStringHelper* command)
+{
+    _heartbeatInterval = interval;
+    _heartbeatCommand = command;
+    _heartbeatMisses = 0;
+}
+
+void NextionControl::linkReceived(uint8_t cmd, unsigned long now)
+{
+    _lastFrameTime = now;
+    _heartbeatMisses = 0;
+
+    NextionLinkState previous = _linkState;
+
+    if (cmd == 0x86)
+        setLinkState(LinkSleeping);
+    else if (cmd == 0x87 || cmd == 0x88 || _linkState != LinkSleeping)
+        setLinkState(LinkConnected);
+
+    if (previous != LinkLost || _linkState == LinkLost)
+        return;
+
+#ifdef NEXTION_DEBUG
+    debugLog(String(F("LINK: Display is back, resynchronising")));
 #endif
-        _readingMessage = false;
-        _terminatorCount = 0;
-        _serialBufferPos = 0;
+
+    // Commands sent while lost were never acknowledged, and the display may have rebooted meanwhile
+    restartAckTracking();
+
+    // The display may have been navigated while unreachable; a page report already answers that
+    if (cmd != 0x66)
         requestCurrentPage();
+
+    if (currentPage)
+    {
+        currentPage->invalidateWidgets();
+        currentPage->refresh(now);
+        currentPage->flushWidgets(now);
+        refreshTimer = now;
+    }
+}
+
+void NextionControl::checkLink(unsigned long now)
+{
+    // A sleeping display is expected to be quiet; its wake-up frame restarts the interval
+    if (_heartbeatInterval == 0 || _linkState == LinkSleeping)
+        return;
+
+    // A heartbeat is unanswered once its reply is overdue or the next one is due
+    unsigned long replyTimeout = _heartbeatInterval < LinkReplyTimeout ? _heartbeatInterval : LinkReplyTimeout;
+
+    if (_heartbeatMisses >= LinkMaxMisses && _linkState != LinkLost && (now - _heartbeatTime) >= replyTimeout)
+    {
+        _linkLosses++;
+        setLinkState(LinkLost);
     }
+
+    if ((now - _lastFrameTime) < _heartbeatInterval || (_heartbeats > 0 && (now - _heartbeatTime) < _heartbeatInterval))
+        return;
+
+    if (_heartbeatCommand)
+        sendCommand(_heartbeatCommand);
+    else
+        requestCurrentPage();
+
+    _heartbeatTime = now;
+    _heartbeats++;
+
+    if (_heartbeatMisses < 0xFF)
+        _heartbeatMisses++;
+}
+
+void NextionControl::setLinkState(NextionLinkState state)
+{
+    if (state == _linkState)
+        return;
+
+    NextionLinkState previous = _linkState;
+    _linkState = state;
+    _linkStateChanges++;
+
+#ifdef NEXTION_DEBUG
+    debugLog(String(F("LINK: State ")) + String(previous) + String(F(" -> ")) + String(state));
+#endif
+
+    if (_linkCallback)
+        _linkCallback(state, previous);
 }
 
 void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
@@ -175,6 +729,7 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
         return;
 
     uint8_t cmd = data[0];
+    linkReceived(cmd, millis());
 
 #ifdef NEXTION_DEBUG
     String hexData = String(F("Nextion MSG: 0x")) + String(cmd, HEX) + String(F(" len=")) + String(len) + String(F(" data=["));
@@ -187,6 +742,17 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
     debugLog(hexData);
 #endif
 
+    // Startup frame (00 00 00): the display has restarted and lost all state
+    if (NextionParserBase::isStartupFrame(data, len))
+    {
+#ifdef NEXTION_DEBUG
+        debugLog(String(F("  -> Display restart detected, waiting for ready")));
+#endif
+        _resetPending = true;
+        _resetTime = millis();
+        return;
+    }
+
     switch (cmd)
     {
         case 0x01: // Instruction successful
@@ -194,6 +760,16 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
 #ifdef NEXTION_DEBUG
             debugLog(String(F("  -> Instruction successful")));
 #endif
+            if (_tracker)
+            {
+                NextionCommandRecord command;
+                if (_tracker->pop(command))
+                    _tracker->recordOutcome(command, cmd, millis());
+            }
+
+            if (_frameListener)
+                _frameListener->onFrame(data, len);
+
             if (currentPage)
                 currentPage->handleCommandResponse(cmd);
 
@@ -215,6 +791,19 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
             if (currentPage)
                 currentPage->handleErrorCommandResponse(cmd);
 
+            if (_tracker)
+            {
+                NextionCommandRecord command;
+                if (_tracker->pop(command))
+                {
+                    _tracker->recordOutcome(command, cmd, millis());
+                    handleCommandFailure(command, cmd, millis());
+                }
+            }
+
+            if (_frameListener)
+                _frameListener->onFrame(data, len);
+
             break;
         }
 
@@ -250,7 +839,12 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
 
             // Now handle the touch event (currentPage should be synchronized)
             if (currentPage && currentPage->getPageId() == pageId) {
-                currentPage->handleTouch(compId, eventType);
+                NextionTouchEvent event;
+
+                if (!_touchTimer || !_touchTimer->feed(pageId, compId, eventType, millis(), event))
+                    currentPage->handleTouch(compId, eventType);
+                else if (event.type != NextionTouchEvent::None)
+                    currentPage->handleTouchEvent(event);
             }
 #ifdef NEXTION_DEBUG
             else {
@@ -272,6 +866,7 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
             
             // Extract page ID from data[1], ignore any extra bytes
             uint8_t newPageId = data[1];
+            _pageUncertain = false;
             
 #ifdef NEXTION_DEBUG
             if (len > 2) {
@@ -281,9 +876,27 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
             debugLog(String(F("  -> Page change to: ")) + String(newPageId));
 #endif
             
+            if (_tracker)
+                _tracker->popQuery();
+
+            bool sendmeReply = _sendmePending;
+            _sendmePending = false;
+
+            if (sendmeReply && _resetOnPageMismatch && currentPage && currentPage->getPageId() != newPageId)
+            {
+#ifdef NEXTION_DEBUG
+                debugLog(String(F("  -> sendme mismatch, treating as display restart")));
+#endif
+                restoreDisplayState(millis());
+                break;
+            }
+
             // Use centralized page switching logic
             switchToPageById(newPageId);
 
+            if (_frameListener)
+                _frameListener->onFrame(data, len);
+
             break;
         }
 
@@ -303,8 +916,10 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
                     String(F(" event=")) + String(eventType));
 #endif
 
-            if (currentPage)
-                currentPage->handleTouchXY(x, y, eventType);
+            if (_touchCoalesce)
+                coalesceTouch(x, y, eventType);
+            else
+                deliverTouch(x, y, eventType, millis());
 
             break;
         }
@@ -326,6 +941,12 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
 			debugLog(String(F("  -> String: \"")) + textBuffer + String(F("\"")));
 #endif
 
+            if (_tracker)
+                _tracker->popQuery();
+
+            if (_frameListener && _frameListener->onFrame(data, len))
+                break;
+
             if (currentPage)
                 currentPage->handleText(textBuffer);
 
@@ -346,6 +967,12 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
 			debugLog(String(F("  -> Numeric: ")) + String(value));
 #endif
 
+            if (_tracker)
+                _tracker->popQuery();
+
+            if (_frameListener && _frameListener->onFrame(data, len))
+                break;
+
             if (currentPage)
                 currentPage->handleNumeric(value);
 
@@ -365,6 +992,15 @@ void NextionControl::handleNextionMessage(const uint8_t* data, size_t len)
             break;
         }
 
+        case 0x88: // Ready after power-on or reset
+        {
+#ifdef NEXTION_DEBUG
+            debugLog(String(F("  -> Display ready after restart")));
+#endif
+            restoreDisplayState(millis());
+            break;
+        }
+
         default: // Unhandled Nextion cmd
 #ifdef NEXTION_DEBUG
 			debugLog(String(F("  -> Unhandled Nextion command: 0x")) + String(cmd, HEX));
@@ -414,9 +1050,18 @@ bool NextionControl::switchToPageById(uint8_t pageId)
 #endif
     }
     
-    // Activate the new page
+    // Activate the new page; the display has reset its components to HMI defaults
     currentPage = newPage;
     currentPage->_isActive = true;
+
+    if (_tracker)
+        _tracker->setActivePage(currentPage);
+
+    // Releases of the old page's components will not be reported
+    if (_touchTimer)
+        _touchTimer->cancel();
+
+    currentPage->invalidateWidgets();
 	currentPage->onEnterPage();
     
 #ifdef NEXTION_DEBUG
@@ -436,10 +1081,87 @@ bool NextionControl::switchToPageById(uint8_t pageId)
         debugLog(String(F("  -> Page already initialized")));
     }
 #endif
+
+    currentPage->flushWidgets(millis());
     
     return true;
 }
 
+void NextionControl::flushBackgroundPage(unsigned long now)
+{
+    for (size_t i = 0; i < pageCount; i++)
+    {
+        _backgroundPage = (_backgroundPage + 1) % pageCount;
+        BaseDisplayPage* page = pages[_backgroundPage];
+
+        if (page && page != currentPage)
+        {
+            page->flushGlobalWidgets(now);
+            return;
+        }
+    }
+}
+
+void NextionControl::restartAckTracking()
+{
+    if (!_tracker)
+        return;
+
+    _tracker->clear();
+    sendCommand(F("bkcmd=3"));
+}
+
+void NextionControl::restoreDisplayState(unsigned long now)
+{
+    _resetPending = false;
+    _displayResetCount++;
+
+    // Acknowledgements for commands sent before the restart will never arrive
+    restartAckTracking();
+
+    // A touch in progress will never be released
+    _touchDown = false;
+    _touchPending = false;
+
+    if (_gestures)
+        _gestures->reset();
+
+    if (_touchTimer)
+        _touchTimer->cancel();
+
+    // The display lost everything, including global components and one-time setup
+    for (size_t i = 0; i < pageCount; i++)
+    {
+        if (!pages[i])
+            continue;
+
+        pages[i]->_initialized = false;
+        pages[i]->invalidateWidgets(true);
+    }
+
+    if (!currentPage)
+    {
+        requestCurrentPage();
+        return;
+    }
+
+#ifdef NEXTION_DEBUG
+    debugLog(String(F("NextionControl: Restoring page ")) + String(currentPage->getPageId()) + String(F(" after display restart")));
+#endif
+
+    // The display boots to its start page; navigate back to the tracked one
+    NextionFlash::write(nextionSerialPort, PSTR("page "));
+    nextionSerialPort->print(currentPage->getPageId());
+    endCommand();
+
+    currentPage->begin();
+    currentPage->_initialized = true;
+    currentPage->onEnterPage();
+    currentPage->refresh(now);
+    currentPage->flushWidgets(now);
+    refreshTimer = now;
+}
+
 void NextionControl::refreshCurrentPage()
 {
     if (currentPage)
@@ -449,7 +1171,8 @@ void NextionControl::refreshCurrentPage()
 void NextionControl::requestCurrentPage()
 {
     // Send "sendme" command - Nextion will respond with 0x66 page change message
-    sendCommand(String(F("sendme")));
+    sendCommand(F("sendme"));
+    _sendmePending = true;
     
 #ifdef NEXTION_DEBUG
     debugLog(String(F("NextionControl: Requested current page from display (sendme)")));
@@ -3,6 +3,8 @@
 
 #include <Arduino.h>
 #include "BaseDisplayPage.h"
+#include "NextionCommandQueue.h"
+#include "NextionParser.h"
 
 /**
  * @def NEXTION_DEBUG
@@ -22,6 +24,42 @@
  */
  // #define NEXTION_DEBUG
 
+/**
+ * @def NEXTION_NO_HEAP
+ * @brief Build the library without any dynamic memory allocation.
+ *
+ * When defined:
+ * - The page table is held in fixed storage sized by `NEXTION_MAX_PAGES`
+ *   instead of being allocated with `new[]` in the constructor.
+ * - The `String` overload of `sendCommand()` is removed so no caller can
+ *   accidentally build heap strings through the library API.
+ * - `NEXTION_DEBUG` cannot be combined with this mode, as all debug output is
+ *   built with `String`.
+ *
+ * Like `NEXTION_DEBUG` and `NEXTION_HEAP_GUARD`, this changes the class layout
+ * and must be defined for the whole build (compiler flag), not in a sketch.
+ *
+ * Intended for boards that forbid heap use after initialization. Combine with
+ * `NEXTION_HEAP_GUARD` in host test builds to verify that `update()` performs no
+ * allocation (see NextionHeapGuard.h).
+ */
+ // #define NEXTION_NO_HEAP
+
+#ifdef NEXTION_NO_HEAP
+#ifdef NEXTION_DEBUG
+#error "NEXTION_DEBUG uses String and cannot be combined with NEXTION_NO_HEAP"
+#endif
+
+#ifndef NEXTION_MAX_PAGES
+/// Maximum number of pages that can be registered when NEXTION_NO_HEAP is defined.
+#define NEXTION_MAX_PAGES 16
+#endif
+#endif
+
+#ifdef NEXTION_HEAP_GUARD
+#include "NextionHeapGuard.h"
+#endif
+
 /**
  * @file NextionControl.h
  * @brief High-level controller for a Nextion HMI display.
@@ -41,12 +79,33 @@
 /// Time in milliseconds between periodic page refresh calls.
 const int RefreshTime = 1000;          // ms between periodic updates
 
+/// Time in milliseconds between low-priority passes updating global widgets of inactive pages.
+const unsigned long BackgroundFlushTime = 100;
+
 /// Size of the internal serial receive buffer used to assemble messages.
 const size_t SerialBufferSize = 256;
 
 /// Timeout (ms) for considering a partial message as aborted when no more bytes arrive.
 const unsigned long SerialTimeout = 600;
 
+/// Minimum time (ms) between `sendme` requests made to recover from framing errors.
+const unsigned long ResyncBackoffMin = 500;
+
+/// Maximum back-off (ms) between recovery `sendme` requests; also the quiet time that resets the back-off.
+const unsigned long ResyncBackoffMax = 16000;
+
+/// Time (ms) to wait for a reply to a heartbeat before it counts as missed.
+const unsigned long LinkReplyTimeout = 1000;
+
+/// Consecutive missed heartbeats after which the link is considered lost.
+const uint8_t LinkMaxMisses = 2;
+
+/// Time (ms) to wait for the 0x88 "ready" frame after a display restart before restoring state anyway.
+const unsigned long DisplayReadyTimeout = 2000;
+
+/// Time (ms) `nextDeadline()` allows while rate-limited widget values are pending.
+const unsigned long UpdatePollInterval = 10;
+
 /// Touch event code reported by Nextion for a press.
 const byte EventPress = 1;
 
@@ -54,6 +113,109 @@ const byte EventPress = 1;
 const byte EventRelease = 0;
 
 
+/**
+ * @brief State of the serial link to the display.
+ */
+enum NextionLinkState : uint8_t {
+    /// No frame received yet.
+    LinkUnknown = 0,
+    /// Frames are being received.
+    LinkConnected = 1,
+    /// The display reported sleep (0x86) and has not woken up (0x87) yet.
+    LinkSleeping = 2,
+    /// Heartbeats went unanswered: unplugged, unpowered or wedged.
+    LinkLost = 3
+};
+
+/// Called on every link state change.
+typedef void (*LinkStateCallback)(NextionLinkState state, NextionLinkState previous);
+
+/**
+ * @class NextionFrameListener
+ * @brief Extension point observing received frames, for layers built on the controller.
+ */
+class NextionFrameListener {
+public:
+    /**
+     * @brief Called for results (0x01 and error codes), page reports (0x66),
+     *        string (0x70) and numeric (0x71) returns.
+     * @param frame Frame payload, terminator excluded; valid only during the call.
+     * @param length Payload length.
+     * @return true to consume a 0x70/0x71 return so the page does not receive it;
+     *         ignored for other frames.
+     */
+    virtual bool onFrame(const uint8_t* frame, size_t length) = 0;
+
+    /**
+     * @brief Called once per `update()`, after received data has been processed.
+     * @param now Current time in milliseconds.
+     */
+    virtual void onUpdate(unsigned long now) = 0;
+
+    /**
+     * @brief Time `onUpdate()` next has work, for event loops that sleep between updates.
+     * @param due Receives the time in milliseconds.
+     * @return false if nothing is scheduled.
+     */
+    virtual bool nextDeadline(unsigned long& due) const
+    {
+        (void)due;
+        return false;
+    }
+
+protected:
+    ~NextionFrameListener() {}
+};
+
+/**
+ * @class NextionBufferedStream
+ * @brief `Stream` that exposes its receive buffer, so the controller parses
+ *        whole blocks instead of calling `available()`/`read()` per byte.
+ *
+ * Implemented by backends that read from the OS in large chunks
+ * (e.g. `NextionPosixSerial`). The controller picks it up automatically when
+ * constructed with one.
+ */
+class NextionBufferedStream : public Stream {
+public:
+    /**
+     * @brief Access received bytes without copying, reading from the device if the buffer is empty.
+     * @param data Receives a pointer to the bytes, valid until `consumeBlock()` or the next read.
+     * @return Number of bytes at `data` (0 if nothing was received).
+     */
+    virtual size_t receiveBlock(const uint8_t*& data) = 0;
+
+    /// @brief Remove bytes returned by `receiveBlock()` from the buffer.
+    virtual void consumeBlock(size_t length) = 0;
+};
+
+/**
+ * @struct NextionLinkStats
+ * @brief Counters describing the health of the serial link.
+ */
+struct NextionLinkStats {
+    /// @brief Framing errors recovered from (damaged terminators, stalled frames, overflows).
+    uint32_t resyncs;
+
+    /// @brief Received bytes that could not be delivered in a frame.
+    uint32_t discardedBytes;
+
+    /// @brief `sendme` requests sent because the current page was uncertain after a framing error.
+    uint16_t pageRequests;
+
+    /// @brief Heartbeats sent.
+    uint16_t heartbeats;
+
+    /// @brief Number of link state changes.
+    uint16_t stateChanges;
+
+    /// @brief Number of times the link was lost.
+    uint16_t losses;
+
+    /// @brief Current link state.
+    NextionLinkState state;
+};
+
 #ifdef NEXTION_DEBUG
 // Forward declaration for debug callback
 typedef void (*DebugCallback)(const String& message);
@@ -83,10 +245,20 @@ public:
      *                   The lifetime must exceed that of this controller.
      * @param pageArray  Array of pointers to page instances. The controller does not take ownership
      *                   and expects the pages to remain valid for the controller's lifetime.
-     * @param count      Number of entries in `pageArray`.
+     * @param count      Number of entries in `pageArray`. When `NEXTION_NO_HEAP` is defined,
+     *                   entries beyond `NEXTION_MAX_PAGES` are left out, `begin()` fails
+     *                   and `getDroppedPageCount()` reports them.
      */
     NextionControl(Stream* serialPort, BaseDisplayPage** pageArray, size_t count);
 
+    /**
+     * @brief Construct a controller on a port that exposes its receive buffer.
+     *
+     * Received data is parsed block by block from the port's buffer.
+     * Parameters are as for the `Stream` constructor.
+     */
+    NextionControl(NextionBufferedStream* serialPort, BaseDisplayPage** pageArray, size_t count);
+
     /// @brief Destructor. Does not delete provided page instances or the serial port.
     ~NextionControl();
 
@@ -96,10 +268,14 @@ public:
      * Sends the necessary setup commands and calls `begin()` on the first page
      * if available.
      *
-     * @return true on successful initialization; false otherwise.
+     * @return true on successful initialization; false if pages were left out
+     *         (see `getDroppedPageCount()`).
      */
     bool begin();
 
+    /// @brief Number of pages passed to the constructor that did not fit `NEXTION_MAX_PAGES`.
+    size_t getDroppedPageCount() const { return _droppedPages; }
+
     /**
      * @brief Run periodic tasks and process incoming serial data.
      *
@@ -107,19 +283,92 @@ public:
      * - Reads from the `Stream` and parses complete messages.
      * - Dispatches messages to the active page.
      * - Triggers periodic `refresh()` on the current page according to `RefreshTime`.
+     * - When otherwise idle, every `BackgroundFlushTime` ms, sends pending global
+     *   widgets of one inactive page using qualified `page.component` writes.
+     *
+     * The controller itself performs no heap allocation here (outside of
+     * `NEXTION_DEBUG` builds). When `NEXTION_HEAP_GUARD` is defined the call is
+     * wrapped in a `NextionHeapGuard::Scope` so host tests can detect
+     * allocations made by the controller or page handlers.
      *
      * @param now Current time in milliseconds (typically from `millis()`).
      */
     void update(unsigned long now);
 
+    /**
+     * @brief Time by which `update()` must next be called if no data arrives.
+     *
+     * For event loops that sleep until the port is readable or this time has
+     * come (e.g. `NextionEventLoop`). Covers the periodic refresh, pending
+     * widgets, timeouts, heartbeats, touch timing, tracked commands, the frame
+     * listener and the command queue. While the link is `LinkLost` only
+     * heartbeats, timeouts, touch timing and the frame listener count, as
+     * `update()` suspends the rest. Commands posted from other threads do not
+     * change a deadline already waited on; such loops must be woken.
+     *
+     * @param now Current time in milliseconds.
+     * @return Time in milliseconds, at most `RefreshTime` after `now`; may be
+     *         earlier than `now` when work is already due.
+     */
+    unsigned long nextDeadline(unsigned long now) const;
+
     /**
      * @brief Send a raw Nextion command.
      *
-     * Appends the required 0xFF 0xFF 0xFF terminators to the command.
+     * Appends the required 0xFF 0xFF 0xFF terminators to the command. The
+     * command is streamed straight to the port; no heap allocation is made.
      *
-     * @param cmd Command string (e.g., "page 0", "t0.txt=\"Hello\"").
+     * @param cmd Null-terminated command string (e.g., "page 0", "t0.txt=\"Hello\"").
      */
-    void sendCommand(const String& cmd);
+    void sendCommand(const char* cmd);
+
+    /**
+     * @brief Send a raw Nextion command stored in PROGMEM.
+     *
+     * @param cmd Command string stored in PROGMEM (use F() macro).
+     */
+    void sendCommand(const __FlashStringHelper* cmd);
+
+    /**
+     * @brief Send a raw Nextion command from a buffer of known length.
+     *
+     * Useful when the command has been formatted into a local buffer and the
+     * length is already known, avoiding a second scan for the terminator.
+     *
+     * @param cmd    Pointer to the command bytes (need not be null-terminated).
+     * @param length Number of bytes to send from `cmd`.
+     */
+    void sendCommand(const char* cmd, size_t length);
+
+    /**
+     * @brief Send a raw Nextion command held in a `String`.
+     *
+     * Retained for compatibility; prefer the `const char*` or F() overloads,
+     * which do not require the caller to build a heap `String`.
+     *
+     * @param cmd Command string.
+     */
+#ifndef NEXTION_NO_HEAP
+    void sendCommand(const String& cmd) { sendCommand(cmd.c_str(), cmd.length()); }
+#endif
+
+    /**
+     * @brief Send a prepared command with a numeric slot value.
+     *
+     * Formats only the slot bytes and writes the whole command in one call.
+     *
+     * @param command Prepared command template (see NextionPreparedCommand.h).
+     * @param value   Value for the slot.
+     */
+    void sendPrepared(NextionPreparedCommandBase& command, int32_t value);
+
+    /**
+     * @brief Send a prepared command with a text slot value.
+     *
+     * @param command Prepared command template (see NextionPreparedCommand.h).
+     * @param text    Text for the slot; truncated if it does not fit.
+     */
+    void sendPrepared(NextionPreparedCommandBase& command, const char* text);
 
     /**
      * @brief Force an immediate refresh of the current page.
@@ -146,6 +395,148 @@ public:
      */
     BaseDisplayPage* getCurrentPage() const { return currentPage; }
 
+    /**
+     * @brief Treat a `sendme` reply naming a different page as a display restart.
+     *
+     * Display restarts are always detected from the startup frames
+     * (`00 00 00` and `88`). Some panels (or brown-outs that cut the link
+     * before the startup frames are read) only reveal the restart when the
+     * page reported in answer to `sendme` differs from the tracked page.
+     *
+     * Enable this only if the display never changes page on its own (all
+     * navigation is driven by the host); otherwise the reply is taken as a
+     * page change and followed, which is the default.
+     *
+     * @param enabled true to restore the tracked page on a `sendme` mismatch.
+     */
+    void setResetOnPageMismatch(bool enabled) { _resetOnPageMismatch = enabled; }
+
+    /**
+     * @brief Get serial link counters.
+     * @return Resynchronisations, discarded bytes, recovery page requests and link state.
+     */
+    NextionLinkStats getLinkStats() const;
+
+#ifdef NEXTION_COMMAND_QUEUE
+    /**
+     * @brief Attach a queue of commands posted by other tasks or ISRs.
+     *
+     * Each `update()` sends up to `CommandQueueDrainLimit` queued commands, in
+     * order, before refreshing the page. Draining pauses while the link is lost.
+     * Only the task calling `update()` may write to the port directly.
+     *
+     * @param queue Queue to drain, or nullptr to detach.
+     */
+    void setCommandQueue(NextionCommandQueueBase* queue) { _commandQueue = queue; }
+#endif
+
+    /**
+     * @brief Attach a listener to received frames (e.g. `NextionCoroutines`).
+     * @param listener Listener, or nullptr to detach.
+     */
+    void setFrameListener(NextionFrameListener* listener) { _frameListener = listener; }
+
+    /**
+     * @brief Enable a heartbeat that detects a lost display.
+     *
+     * When nothing has been received for `interval` ms, the heartbeat command is
+     * sent (at most once per interval). After `LinkMaxMisses` unanswered
+     * heartbeats the link becomes `LinkLost`:
+     * - page refreshes, widget flushes and command retries are suspended, so
+     *   widget values stay pending instead of being sent into the void;
+     * - heartbeats continue at the same low rate;
+     * - the first frame received brings the link back, re-sends the current
+     *   page's state and asks the display for its current page.
+     *
+     * A sleeping display (0x86) is not polled and cannot be lost: heartbeats and
+     * miss counting resume a full interval after it wakes (0x87 or 0x88).
+     *
+     * @param interval Idle time (ms) before a heartbeat, or 0 to disable (default).
+     * @param command Heartbeat command; nullptr for `sendme`. The reply of a
+     *                custom command (e.g. `get dp`) is delivered to the page as usual.
+     */
+    void setHeartbeat(unsigned long interval, const __FlashStringHelper* command = nullptr);
+
+    /**
+     * @brief Set a function called on every link state change.
+     * @param callback Function to call, or nullptr.
+     */
+    void setLinkStateCallback(LinkStateCallback callback) { _linkCallback = callback; }
+
+    /// @brief Current link state.
+    NextionLinkState getLinkState() const { return _linkState; }
+
+    /**
+     * @brief Coalesce touch coordinate events (0x67/0x68, `sendxy=1`).
+     *
+     * When enabled, intermediate points of a touch are not dispatched as they
+     * arrive; only the latest point is delivered to `handleTouchXY()` once per
+     * `update()`. Press and release transitions are always delivered, in order,
+     * immediately after any point still pending. Decimation drops further points:
+     * - `minDistance`: a point closer than this (pixels) to the last delivered
+     *   point is dropped.
+     * - `minInterval`: the latest point is held until this many ms have passed
+     *   since the last delivered point.
+     *
+     * @param enabled true to coalesce, false to dispatch every point (default).
+     * @param minDistance Minimum movement in pixels (0 = any).
+     * @param minInterval Minimum time between delivered points in ms (0 = none).
+     */
+    void setTouchCoalescing(bool enabled, uint16_t minDistance = 0, uint16_t minInterval = 0);
+
+    /**
+     * @brief Attach a touch timer for long-press, auto-repeat and debounce.
+     *
+     * Touch events of components registered with the timer are delivered to
+     * `handleTouchEvent()` instead of `handleTouch()`. Repeats, long presses and
+     * debounced releases are generated from `update()`. Press state is cancelled
+     * on page changes.
+     *
+     * @param timer Timer holding the component timings, or nullptr to detach.
+     */
+    void setTouchTimer(NextionTouchTimer* timer);
+
+    /**
+     * @brief Attach a gesture recognizer to the XY touch stream.
+     *
+     * Touch coordinate events are then fed to the recognizer, and pages receive
+     * `handleGesture()` calls instead of `handleTouchXY()`. Long presses and drag
+     * movement are reported from `update()`, at most one drag per pass.
+     * Combine with `setTouchCoalescing()` to also skip recognizer work for
+     * intermediate points.
+     *
+     * @param recognizer Recognizer to feed, or nullptr to deliver raw points again.
+     */
+    void setGestureRecognizer(NextionGestureRecognizer* recognizer);
+
+    /**
+     * @brief Get the number of touch points dropped by coalescing and decimation.
+     * @return Dropped point count since construction.
+     */
+    uint32_t getDroppedTouchPoints() const { return _touchDropped; }
+
+    /**
+     * @brief Enable or disable per-command acknowledgement tracking.
+     *
+     * Routes all output of the controller and its pages through `tracker` and
+     * sends `bkcmd=3`, so every command is acknowledged and each ack or error is
+     * matched to the command that caused it (see NextionCommandTracker.h).
+     * Transient failures (0x00 or no ack within `CommandAckTimeout`) of prepared
+     * templates and widget values are retried up to `CommandMaxRetries` times
+     * with exponential backoff. Final failures are reported to the sending page
+     * through `BaseDisplayPage::handleCommandFailure()`.
+     *
+     * @param tracker Tracker wrapping the same port passed to the constructor,
+     *                or nullptr to stop tracking (sends `bkcmd=2`).
+     */
+    void setAckTracking(NextionCommandTracker* tracker);
+
+    /**
+     * @brief Get the number of display restarts detected and recovered from.
+     * @return Restart count since construction.
+     */
+    uint16_t getDisplayResetCount() const { return _displayResetCount; }
+
 #ifdef NEXTION_DEBUG
     /**
      * @brief Set debug message callback.
@@ -165,29 +556,31 @@ public:
 
 #endif
 private:
-    /// @brief Indicates if a message is currently being assembled from the serial stream.
-	bool _readingMessage = false;
-
     /// @brief Timestamp (ms) of the last received character for timeout management.
     unsigned long _lastCharTime = 0;
 
-    /// @brief Count of 0xFF terminator bytes observed for the current message.
-    uint8_t _terminatorCount;
-
-    /// @brief Buffer holding bytes received from the serial stream.
-    uint8_t _serialBuffer[SerialBufferSize];
-
-    /// @brief Current write position within `_serialBuffer`.
-    size_t _serialBufferPos;
+    /// @brief Assembles messages received from the display.
+    NextionParser<SerialBufferSize> _parser;
 
     /// @brief Stream connected to the Nextion display.
     Stream* nextionSerialPort;
 
+    /// @brief Same port when it exposes its receive buffer, else nullptr.
+    NextionBufferedStream* _bufferedPort = nullptr;
+
     /// @brief Total number of managed pages.
     size_t pageCount;
 
+    /// @brief Pages left out because the fixed page table was full.
+    size_t _droppedPages = 0;
+
+#ifdef NEXTION_NO_HEAP
+    /// @brief Fixed table of pointers to page instances (not owned).
+    BaseDisplayPage* pages[NEXTION_MAX_PAGES];
+#else
     /// @brief Array of pointers to page instances (not owned).
     BaseDisplayPage** pages;
+#endif
 
     /// @brief Index of the current page.
     uint8_t currPage;
@@ -198,12 +591,213 @@ private:
     /// @brief Pointer to the currently active page.
     BaseDisplayPage* currentPage = nullptr;
 
+    /// @brief Index of the page last given a background flush of its global widgets.
+    size_t _backgroundPage = 0;
+
+    /// @brief Timestamp of the last background flush pass.
+    unsigned long _backgroundTimer = 0;
+
+    /// @brief A `sendme` has been sent and its 0x66 reply not yet received.
+    bool _sendmePending = false;
+
+    /// @brief A framing error may have lost a page change; a `sendme` is due once the back-off allows.
+    bool _pageUncertain = false;
+
+    /// @brief Current back-off between recovery `sendme` requests (0 = next one is immediate).
+    unsigned long _resyncBackoff = 0;
+
+    /// @brief Time of the last recovery `sendme`.
+    unsigned long _resyncRequestTime = 0;
+
+    /// @brief Number of recovery `sendme` requests.
+    uint16_t _pageRequests = 0;
+
+#ifdef NEXTION_COMMAND_QUEUE
+    /// @brief Commands posted by other tasks, or nullptr.
+    NextionCommandQueueBase* _commandQueue = nullptr;
+#endif
+
+    /// @brief Observer of received frames, or nullptr.
+    NextionFrameListener* _frameListener = nullptr;
+
+    /// @brief Link state derived from received frames and heartbeats.
+    NextionLinkState _linkState = LinkUnknown;
+
+    /// @brief Called on link state changes, or nullptr.
+    LinkStateCallback _linkCallback = nullptr;
+
+    /// @brief Heartbeat command, or nullptr for `sendme`.
+    const __FlashStringHelper* _heartbeatCommand = nullptr;
+
+    /// @brief Idle time (ms) before a heartbeat (0 = disabled).
+    unsigned long _heartbeatInterval = 0;
+
+    /// @brief Time the last frame was received.
+    unsigned long _lastFrameTime = 0;
+
+    /// @brief Time the last heartbeat was sent.
+    unsigned long _heartbeatTime = 0;
+
+    /// @brief Heartbeats sent since the last received frame.
+    uint8_t _heartbeatMisses = 0;
+
+    /// @brief Link counters not kept by the parser.
+    uint16_t _heartbeats = 0;
+    uint16_t _linkStateChanges = 0;
+    uint16_t _linkLosses = 0;
+
+    /**
+     * @brief Update the link state for a received frame.
+     * @param cmd Frame's return code.
+     * @param now Current time in milliseconds.
+     */
+    void linkReceived(uint8_t cmd, unsigned long now);
+
+    /// @brief Send heartbeats and detect a lost link.
+    void checkLink(unsigned long now);
+
+    /// @brief Change the link state and report it.
+    void setLinkState(NextionLinkState state);
+
+    /**
+     * @brief Check whether a lost frame could have changed the page state.
+     * @param header First byte of the lost frame.
+     */
+    static bool affectsPage(uint8_t header);
+
+    /**
+     * @brief Lower a deadline to a candidate time if it is earlier.
+     * @param due Deadline being computed.
+     * @param candidate Time something falls due.
+     */
+    static void keepEarlier(unsigned long& due, unsigned long candidate);
+
+    /// @brief Send a recovery `sendme` if the page is uncertain and the back-off has elapsed.
+    void resyncPage(unsigned long now);
+
+    /// @brief Whether a mismatching `sendme` reply is treated as a display restart.
+    bool _resetOnPageMismatch = false;
+
+    /// @brief Startup frame seen; state is restored on the 0x88 frame or after `DisplayReadyTimeout`.
+    bool _resetPending = false;
+
+    /// @brief Time the startup frame was received.
+    unsigned long _resetTime = 0;
+
+    /// @brief Number of display restarts recovered from.
+    uint16_t _displayResetCount = 0;
+
+    /// @brief Whether touch coordinate events are coalesced.
+    bool _touchCoalesce = false;
+
+    /// @brief true while a finger is down, according to delivered press/release events.
+    bool _touchDown = false;
+
+    /// @brief A coalesced point is waiting to be delivered.
+    bool _touchPending = false;
+
+    /// @brief Minimum movement (pixels) for a coalesced point to be delivered.
+    uint16_t _touchMinDistance = 0;
+
+    /// @brief Minimum time (ms) between delivered points.
+    uint16_t _touchMinInterval = 0;
+
+    /// @brief Latest coalesced point.
+    uint16_t _touchX = 0;
+    uint16_t _touchY = 0;
+
+    /// @brief Last point delivered to the page, and when.
+    uint16_t _lastTouchX = 0;
+    uint16_t _lastTouchY = 0;
+    unsigned long _lastTouchTime = 0;
+
+    /// @brief Points dropped by coalescing and decimation.
+    uint32_t _touchDropped = 0;
+
+    /// @brief Gesture recognizer fed with touch points, or nullptr.
+    NextionGestureRecognizer* _gestures = nullptr;
+
+    /// @brief Touch timer for registered components, or nullptr.
+    NextionTouchTimer* _touchTimer = nullptr;
+
+    /// @brief Deliver a timed touch event if it belongs to the current page.
+    void deliverTouchEvent(const NextionTouchEvent& event);
+
+    /**
+     * @brief Queue or deliver a touch coordinate event.
+     * @param x X coordinate.
+     * @param y Y coordinate.
+     * @param eventType Press (1) or release (0).
+     */
+    void coalesceTouch(uint16_t x, uint16_t y, uint8_t eventType);
+
+    /**
+     * @brief Deliver the pending coalesced point if decimation allows it.
+     * @param now Current time in milliseconds.
+     * @param force Deliver regardless of the interval (before a transition).
+     */
+    void flushTouch(unsigned long now, bool force);
+
+    /// @brief Deliver a point to the gesture recognizer or the current page and remember it.
+    void deliverTouch(uint16_t x, uint16_t y, uint8_t eventType, unsigned long now);
+
+    /// @brief Acknowledgement tracker, or nullptr when tracking is disabled.
+    NextionCommandTracker* _tracker = nullptr;
+
+    /**
+     * @brief Retry or report a command that failed.
+     * @param command Failed command.
+     * @param responseCode Error code, or `CommandTimeoutCode`.
+     * @param now Current time in milliseconds.
+     */
+    void handleCommandFailure(const NextionCommandRecord& command, uint8_t responseCode, unsigned long now);
+
+    /**
+     * @brief Re-send a failed idempotent command.
+     * @param command Command whose backoff has elapsed.
+     * @param now Current time in milliseconds.
+     */
+    void retryCommand(const NextionCommandRecord& command, unsigned long now);
+
+    /**
+     * @brief Bring a restarted display back to the tracked state.
+     *
+     * Marks every page for `begin()` again, invalidates all widgets (global ones
+     * included, as a restart clears them too), navigates back to the tracked
+     * page and re-sends its state in one burst. Global widgets of inactive
+     * pages follow through the paced background flush.
+     *
+     * @param now Current time in milliseconds.
+     */
+    void restoreDisplayState(unsigned long now);
+
+    /**
+     * @brief Drop tracked commands and re-enable acknowledgements after recovery.
+     *
+     * A rebooted or replaced panel comes back with its HMI default `bkcmd` and
+     * would no longer acknowledge successful commands.
+     */
+    void restartAckTracking();
+
+    /**
+     * @brief Send pending global widgets of the next inactive page (round robin).
+     * @param now Current time in milliseconds.
+     */
+    void flushBackgroundPage(unsigned long now);
+
     /**
      * @brief Drain the serial port and assemble/parse messages.
      * @param now Current time in milliseconds for timeout calculations.
      */
     void readSerial(unsigned long now);
 
+    /**
+     * @brief Feed one received byte to the parser and dispatch a completed frame.
+     * @param b Received byte.
+     * @return false if the receive buffer overflowed (stop reading for this pass).
+     */
+    bool receiveByte(uint8_t b);
+
     /**
      * @brief Switch to a page by its page ID.
      * 
@@ -222,6 +816,9 @@ private:
      */
     void handleNextionMessage(const uint8_t* data, size_t len);
 
+    /// @brief Write the 0xFF 0xFF 0xFF command terminator in a single block write.
+    void endCommand();
+
 #ifdef NEXTION_DEBUG
     /// @brief Debug message callback (nullptr if not set).
     DebugCallback debugCallback = nullptr;
@@ -0,0 +1,498 @@
+#pragma once
+
+#include <Arduino.h>
+#include "NextionControl.h"
+
+/**
+ * @file NextionCoroutines.h
+ * @brief Optional C++20 coroutine layer for request/response sequences.
+ *
+ * Flows such as "read three values, wait for the ack, switch page, wait for
+ * 0x66" otherwise become state machines spread over `handleNumeric()`,
+ * `handleCommandResponse()` and `refresh()`. With `NextionCoroutines` they are
+ * written as one function returning `NextionTask`:
+ * @code
+ * NextionCoroutines co(&nextion);
+ *
+ * NextionTask calibrate()
+ * {
+ *     NextionAwaitResult low = co_await co.number(F("get n0.val"));
+ *     NextionAwaitResult high = co_await co.number(F("get n1.val"));
+ *     if (!low.ok || !high.ok)
+ *         co_return;
+ *
+ *     nextion.sendCommand(F("page 2"));
+ *     if ((co_await co.page(2, 1000)).ok)
+ *         co_await co.delay(500);
+ * }
+ * @endcode
+ *
+ * - Awaitables: `number()` and `text()` send a query and wait for its 0x71 /
+ *   0x70 return, `ack()` waits for the next 0x01 (requires `bkcmd=1` or `3`),
+ *   `page()` waits for a 0x66 page report, `delay()` waits for a time. Each
+ *   resolves with `NextionAwaitResult`; errors and timeouts give `ok == false`.
+ * - Coroutines are resumed from `NextionControl::update()`, on the thread that
+ *   runs pages, when the awaited frame arrives or the timeout passes.
+ *   Returns consumed by a coroutine are not passed to the page.
+ * - Frames come from a fixed pool of `CoroutineFrameSlots` blocks of
+ *   `CoroutineFrameSize` bytes; nothing is allocated on the heap. When the pool
+ *   is exhausted, or a coroutine's frame is larger than a block, the coroutine
+ *   does not start and the returned `NextionTask` is false. Each `co_await`
+ *   in a coroutine adds about 40 bytes to its frame.
+ *
+ * Available where the compiler supports C++20 coroutines (ESP32 with
+ * `-std=gnu++2a`, host builds); `NEXTION_COROUTINES` is then defined.
+ */
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define NEXTION_COROUTINES 1
+#endif
+#endif
+
+#ifdef NEXTION_COROUTINES
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdlib.h>
+
+/// Number of coroutine frames that can exist at once (at most 8).
+const uint8_t CoroutineFrameSlots = 4;
+
+/// Size of one coroutine frame block in bytes.
+const size_t CoroutineFrameSize = 768;
+
+/// Number of coroutines that can be suspended on an awaitable at once.
+const uint8_t CoroutineWaitSlots = 8;
+
+/// `NextionAwaitResult::code` when the waiter table was full or waits were cancelled.
+const uint8_t CoroutineCancelledCode = 0xFE;
+
+/**
+ * @class NextionFramePool
+ * @brief Fixed storage for coroutine frames.
+ */
+class NextionFramePool {
+    static_assert(CoroutineFrameSlots <= 8, "At most 8 coroutine frames");
+
+public:
+    /**
+     * @brief Take a free block.
+     * @param size Frame size requested by the compiler.
+     * @return Block, or nullptr if the frame is too large or the pool is exhausted.
+     */
+    static void* allocate(size_t size) noexcept
+    {
+        if (size > CoroutineFrameSize)
+            return nullptr;
+
+        for (uint8_t i = 0; i < CoroutineFrameSlots; i++)
+        {
+            if (!(_used & (1u << i)))
+            {
+                _used |= static_cast<uint8_t>(1u << i);
+                return _storage[i].bytes;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /// @brief Return a block taken with `allocate()`.
+    static void release(void* block) noexcept
+    {
+        for (uint8_t i = 0; i < CoroutineFrameSlots; i++)
+        {
+            if (_storage[i].bytes == block)
+                _used &= static_cast<uint8_t>(~(1u << i));
+        }
+    }
+
+    /// @brief Number of blocks in use.
+    static uint8_t inUse()
+    {
+        uint8_t count = 0;
+
+        for (uint8_t i = 0; i < CoroutineFrameSlots; i++)
+        {
+            if (_used & (1u << i))
+                count++;
+        }
+
+        return count;
+    }
+
+private:
+    struct Block {
+        alignas(max_align_t) uint8_t bytes[CoroutineFrameSize];
+    };
+
+    static inline Block _storage[CoroutineFrameSlots];
+    static inline uint8_t _used = 0;
+};
+
+/**
+ * @class NextionTask
+ * @brief Return type of a display coroutine.
+ *
+ * The coroutine starts immediately and frees its frame when it returns.
+ * The task converts to false if the coroutine could not be started.
+ */
+class NextionTask {
+public:
+    struct promise_type {
+        NextionTask get_return_object() noexcept { return NextionTask(true); }
+        static NextionTask get_return_object_on_allocation_failure() noexcept { return NextionTask(false); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { abort(); }
+
+        static void* operator new(size_t size) noexcept { return NextionFramePool::allocate(size); }
+        static void operator delete(void* block) noexcept { NextionFramePool::release(block); }
+    };
+
+    /// @brief true if the coroutine was started.
+    explicit operator bool() const { return _started; }
+
+private:
+    explicit NextionTask(bool started) : _started(started) {}
+
+    bool _started;
+};
+
+/**
+ * @struct NextionAwaitResult
+ * @brief Outcome of an awaitable.
+ */
+struct NextionAwaitResult {
+    /// @brief true if the awaited frame arrived (or the delay elapsed).
+    bool ok;
+
+    /// @brief Return code received (0x01, 0x66, 0x70, 0x71 or an error code),
+    ///        `CommandTimeoutCode` or `CoroutineCancelledCode`.
+    uint8_t code;
+
+    /// @brief Number for `number()`, page ID for `page()`.
+    int32_t number;
+
+    /// @brief Text for `text()` (not null-terminated); valid until the coroutine suspends again.
+    const char* text;
+
+    /// @brief Length of `text`.
+    uint16_t length;
+};
+
+/**
+ * @class NextionCoroutines
+ * @brief Awaitable factory and dispatcher resuming coroutines from `NextionControl::update()`.
+ */
+class NextionCoroutines : public NextionFrameListener {
+public:
+    /// `page()` argument matching any page.
+    static const uint8_t AnyPage = 0xFF;
+
+    /**
+     * @brief Construct the dispatcher and attach it to a controller.
+     * @param control Controller whose frames resume the coroutines.
+     */
+    explicit NextionCoroutines(NextionControl* control) : _control(control), _sequence(0)
+    {
+        for (uint8_t i = 0; i < CoroutineWaitSlots; i++)
+            _waiters[i].awaitable = nullptr;
+
+        _control->setFrameListener(this);
+    }
+
+    /**
+     * @class Awaitable
+     * @brief Object returned by the factory methods; use with `co_await`.
+     */
+    class Awaitable {
+    public:
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            // Without a free slot the reply would reach the page as an unrequested return
+            if (!_owner->wait(this, handle))
+                return false;
+
+            if (_query)
+                _owner->_control->sendCommand(_query);
+
+            return true;
+        }
+
+        NextionAwaitResult await_resume() const noexcept { return _result; }
+
+    private:
+        friend class NextionCoroutines;
+
+        Awaitable(NextionCoroutines* owner, uint8_t kind, const __FlashStringHelper* query, unsigned long timeout, uint8_t page)
+            : _owner(owner), _query(query), _timeout(timeout), _kind(kind), _page(page)
+        {
+            _result.ok = false;
+            _result.code = CoroutineCancelledCode;
+            _result.number = 0;
+            _result.text = nullptr;
+            _result.length = 0;
+        }
+
+        NextionCoroutines* _owner;
+        const __FlashStringHelper* _query;
+        unsigned long _timeout;
+        uint8_t _kind;
+        uint8_t _page;
+        NextionAwaitResult _result;
+    };
+
+    /**
+     * @brief Send a query and wait for its numeric return (0x71).
+     * @param query Query in PROGMEM (e.g. F("get n0.val")).
+     * @param timeout Maximum wait in milliseconds.
+     */
+    Awaitable number(const __FlashStringHelper* query, unsigned long timeout = CommandAckTimeout)
+    {
+        return Awaitable(this, WaitNumber, query, timeout, 0);
+    }
+
+    /**
+     * @brief Send a query and wait for its string return (0x70).
+     * @param query Query in PROGMEM (e.g. F("get t0.txt")).
+     * @param timeout Maximum wait in milliseconds.
+     */
+    Awaitable text(const __FlashStringHelper* query, unsigned long timeout = CommandAckTimeout)
+    {
+        return Awaitable(this, WaitText, query, timeout, 0);
+    }
+
+    /**
+     * @brief Wait for the next success result (0x01); an error code fails the wait.
+     * @param timeout Maximum wait in milliseconds.
+     */
+    Awaitable ack(unsigned long timeout = CommandAckTimeout)
+    {
+        return Awaitable(this, WaitAck, nullptr, timeout, 0);
+    }
+
+    /**
+     * @brief Wait for a page report (0x66).
+     * @param pageId Page to wait for, or `AnyPage`.
+     * @param timeout Maximum wait in milliseconds.
+     */
+    Awaitable page(uint8_t pageId = AnyPage, unsigned long timeout = CommandAckTimeout)
+    {
+        return Awaitable(this, WaitPage, nullptr, timeout, pageId);
+    }
+
+    /**
+     * @brief Wait for a time; resolves with `ok == true`.
+     * @param milliseconds Time to wait.
+     */
+    Awaitable delay(unsigned long milliseconds)
+    {
+        return Awaitable(this, WaitDelay, nullptr, milliseconds, 0);
+    }
+
+    /// @brief Resume every waiting coroutine with `CoroutineCancelledCode`.
+    void cancel()
+    {
+        uint32_t snapshot = _sequence;
+
+        for (uint8_t i = 0; i < CoroutineWaitSlots; i++)
+        {
+            if (_waiters[i].awaitable && before(_waiters[i].sequence, snapshot))
+                resume(i, false, CoroutineCancelledCode);
+        }
+    }
+
+    /// @brief Number of coroutines waiting on an awaitable.
+    uint8_t waiting() const
+    {
+        uint8_t count = 0;
+
+        for (uint8_t i = 0; i < CoroutineWaitSlots; i++)
+        {
+            if (_waiters[i].awaitable)
+                count++;
+        }
+
+        return count;
+    }
+
+    bool onFrame(const uint8_t* frame, size_t length) override
+    {
+        uint8_t cmd = frame[0];
+
+        if (cmd == 0x71 && length >= 5)
+        {
+            int8_t index = oldest(1 << WaitNumber);
+            if (index < 0)
+                return false;
+
+            _waiters[index].awaitable->_result.number = static_cast<int32_t>(static_cast<uint32_t>(frame[1]) |
+                (static_cast<uint32_t>(frame[2]) << 8) | (static_cast<uint32_t>(frame[3]) << 16) |
+                (static_cast<uint32_t>(frame[4]) << 24));
+            resume(index, true, cmd);
+            return true;
+        }
+
+        if (cmd == 0x70)
+        {
+            int8_t index = oldest(1 << WaitText);
+            if (index < 0)
+                return false;
+
+            _waiters[index].awaitable->_result.text = reinterpret_cast<const char*>(frame + 1);
+            _waiters[index].awaitable->_result.length = static_cast<uint16_t>(length - 1);
+            resume(index, true, cmd);
+            return true;
+        }
+
+        if (cmd == 0x66 && length >= 2)
+        {
+            uint32_t snapshot = _sequence;
+
+            for (uint8_t i = 0; i < CoroutineWaitSlots; i++)
+            {
+                Waiter& waiter = _waiters[i];
+
+                if (waiter.awaitable && waiter.awaitable->_kind == WaitPage && before(waiter.sequence, snapshot) &&
+                    (waiter.awaitable->_page == AnyPage || waiter.awaitable->_page == frame[1]))
+                {
+                    waiter.awaitable->_result.number = frame[1];
+                    resume(i, true, cmd);
+                }
+            }
+
+            return false;
+        }
+
+        if (length == 1 && cmd <= 0x24)
+        {
+            // A success answers an ack; an error answers the oldest outstanding command
+            int8_t index = oldest(cmd == 0x01 ? (1 << WaitAck) : ((1 << WaitAck) | (1 << WaitNumber) | (1 << WaitText)));
+            if (index >= 0)
+                resume(index, cmd == 0x01, cmd);
+        }
+
+        return false;
+    }
+
+    void onUpdate(unsigned long now) override
+    {
+        uint32_t snapshot = _sequence;
+
+        for (uint8_t i = 0; i < CoroutineWaitSlots; i++)
+        {
+            Waiter& waiter = _waiters[i];
+
+            if (waiter.awaitable && before(waiter.sequence, snapshot) && (now - waiter.start) >= waiter.awaitable->_timeout)
+            {
+                bool delay = waiter.awaitable->_kind == WaitDelay;
+                resume(i, delay, delay ? 0 : CommandTimeoutCode);
+            }
+        }
+    }
+
+    bool nextDeadline(unsigned long& due) const override
+    {
+        bool found = false;
+
+        for (uint8_t i = 0; i < CoroutineWaitSlots; i++)
+        {
+            const Waiter& waiter = _waiters[i];
+
+            if (!waiter.awaitable)
+                continue;
+
+            unsigned long expiry = waiter.start + waiter.awaitable->_timeout;
+
+            if (!found || static_cast<long>(expiry - due) < 0)
+                due = expiry;
+
+            found = true;
+        }
+
+        return found;
+    }
+
+private:
+    enum WaitKind : uint8_t {
+        WaitNumber = 0,
+        WaitText = 1,
+        WaitAck = 2,
+        WaitPage = 3,
+        WaitDelay = 4
+    };
+
+    struct Waiter {
+        Awaitable* awaitable;
+        std::coroutine_handle<> handle;
+        unsigned long start;
+        uint32_t sequence;
+    };
+
+    /// @brief Register a suspended coroutine; false (do not suspend) if the table is full.
+    bool wait(Awaitable* awaitable, std::coroutine_handle<> handle)
+    {
+        for (uint8_t i = 0; i < CoroutineWaitSlots; i++)
+        {
+            Waiter& waiter = _waiters[i];
+
+            if (!waiter.awaitable)
+            {
+                waiter.awaitable = awaitable;
+                waiter.handle = handle;
+                waiter.start = millis();
+                waiter.sequence = _sequence++;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// @brief Oldest waiter of the given kinds (bit mask), or -1.
+    int8_t oldest(uint8_t kinds) const
+    {
+        int8_t found = -1;
+
+        for (uint8_t i = 0; i < CoroutineWaitSlots; i++)
+        {
+            const Waiter& waiter = _waiters[i];
+
+            if (waiter.awaitable && (kinds & (1 << waiter.awaitable->_kind)) &&
+                (found < 0 || before(waiter.sequence, _waiters[found].sequence)))
+            {
+                found = static_cast<int8_t>(i);
+            }
+        }
+
+        return found;
+    }
+
+    /// @brief Complete a wait and resume its coroutine (which may wait again).
+    void resume(uint8_t index, bool ok, uint8_t code)
+    {
+        Waiter& waiter = _waiters[index];
+        std::coroutine_handle<> handle = waiter.handle;
+
+        waiter.awaitable->_result.ok = ok;
+        waiter.awaitable->_result.code = code;
+        waiter.awaitable = nullptr;
+        handle.resume();
+    }
+
+    static bool before(uint32_t sequence, uint32_t other)
+    {
+        return static_cast<int32_t>(sequence - other) < 0;
+    }
+
+    NextionControl* _control;
+    Waiter _waiters[CoroutineWaitSlots];
+    uint32_t _sequence;
+};
+
+#endif
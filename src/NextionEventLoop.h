@@ -0,0 +1,289 @@
+#pragma once
+
+#include <Arduino.h>
+#include "NextionControl.h"
+#include "NextionPosixSerial.h"
+
+/**
+ * @file NextionEventLoop.h
+ * @brief epoll loop driving many displays from one Linux thread.
+ *
+ * Calling `update()` on every controller in a tight loop costs CPU for each
+ * idle display and adds up to one loop period of latency. `NextionEventLoop`
+ * instead registers each controller's `NextionPosixSerial` descriptor with
+ * epoll and sleeps until:
+ * - a port has received data (or can take more output after it was full), or
+ * - the earliest `NextionControl::nextDeadline()` of all controllers has come.
+ *
+ * Only the controllers with readable data or a due deadline are updated.
+ *
+ * @code
+ * NextionPosixSerial ports[16];
+ * NextionControl* displays[16];
+ * NextionEventLoop loop;
+ *
+ * for (int i = 0; i < 16; i++)
+ * {
+ *     ports[i].open(devicePath(i), 115200);
+ *     displays[i] = new NextionControl(&ports[i], pages[i], pageCount);
+ *     displays[i]->begin();
+ *     loop.add(displays[i], &ports[i]);
+ * }
+ *
+ * loop.run();
+ * @endcode
+ *
+ * All controllers are updated on the thread calling `run()`/`runOnce()`.
+ * Other threads may call `wake()` (e.g. after posting to a
+ * `NextionCommandQueue`) and `stop()`.
+ *
+ * Available on Linux (`NEXTION_EVENT_LOOP` is then defined).
+ */
+
+#if defined(NEXTION_POSIX_SERIAL) && defined(__linux__)
+#if __has_include(<sys/epoll.h>) && __has_include(<sys/eventfd.h>)
+#define NEXTION_EVENT_LOOP 1
+#endif
+#endif
+
+#ifdef NEXTION_EVENT_LOOP
+
+#include <atomic>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+/// Maximum number of controllers one loop drives.
+const uint8_t EventLoopMaxDisplays = 64;
+
+/**
+ * @class NextionEventLoop
+ * @brief Readiness- and deadline-driven dispatcher for `NextionControl` instances.
+ */
+class NextionEventLoop {
+public:
+    NextionEventLoop()
+        : _epoll(epoll_create1(EPOLL_CLOEXEC)), _wake(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+          _running(false), _wakeups(0), _updates(0)
+    {
+        for (uint8_t i = 0; i < EventLoopMaxDisplays; i++)
+            _entries[i].control = nullptr;
+
+        if (_epoll >= 0 && _wake >= 0)
+            watch(_wake, EPOLL_CTL_ADD, EPOLLIN, WakeTag);
+    }
+
+    ~NextionEventLoop()
+    {
+        if (_epoll >= 0)
+            ::close(_epoll);
+
+        if (_wake >= 0)
+            ::close(_wake);
+    }
+
+    /// @brief true if the epoll and wake descriptors were created.
+    bool isValid() const { return _epoll >= 0 && _wake >= 0; }
+
+    /**
+     * @brief Drive a controller; its port must be open.
+     * @param control Controller (not owned).
+     * @param port The `NextionPosixSerial` the controller was constructed with.
+     * @return false if the loop is full or the descriptor cannot be watched.
+     */
+    bool add(NextionControl* control, NextionPosixSerial* port)
+    {
+        if (!isValid() || !control || !port || !port->isOpen())
+            return false;
+
+        for (uint8_t i = 0; i < EventLoopMaxDisplays; i++)
+        {
+            Entry& entry = _entries[i];
+
+            if (entry.control)
+                continue;
+
+            if (!watch(port->fd(), EPOLL_CTL_ADD, EPOLLIN, i))
+                return false;
+
+            entry.control = control;
+            entry.port = port;
+            entry.fd = port->fd();
+            entry.events = EPOLLIN;
+            entry.ready = false;
+            return true;
+        }
+
+        return false;
+    }
+
+    /// @brief Stop driving a controller.
+    void remove(NextionControl* control)
+    {
+        for (uint8_t i = 0; i < EventLoopMaxDisplays; i++)
+        {
+            Entry& entry = _entries[i];
+
+            if (entry.control != control)
+                continue;
+
+            if (entry.events)
+                watch(entry.fd, EPOLL_CTL_DEL, 0, i);
+
+            entry.control = nullptr;
+        }
+    }
+
+    /**
+     * @brief Wait for readiness or the earliest deadline, then update the controllers concerned.
+     * @param maxWait Longest wait in milliseconds, or -1 to wait only on descriptors and deadlines.
+     * @return Number of controllers updated, or -1 if the wait failed.
+     */
+    int runOnce(int maxWait = -1)
+    {
+        unsigned long now = millis();
+        long wait = maxWait;
+
+        for (uint8_t i = 0; i < EventLoopMaxDisplays; i++)
+        {
+            Entry& entry = _entries[i];
+
+            if (!entry.control)
+                continue;
+
+            long remaining = static_cast<long>(entry.control->nextDeadline(now) - now);
+            if (remaining < 0)
+                remaining = 0;
+
+            if (wait < 0 || remaining < wait)
+                wait = remaining;
+
+            // Output stuck in the port's buffer needs a wake-up when the device drains
+            uint32_t events = entry.port->hasPendingOutput() ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+            if (entry.events && entry.events != events && watch(entry.fd, EPOLL_CTL_MOD, events, i))
+                entry.events = events;
+        }
+
+        struct epoll_event events[EventLoopMaxDisplays + 1];
+        int count = epoll_wait(_epoll, events, EventLoopMaxDisplays + 1, static_cast<int>(wait));
+
+        if (count < 0)
+            return errno == EINTR ? 0 : -1;
+
+        _wakeups++;
+
+        for (int i = 0; i < count; i++)
+        {
+            uint32_t tag = events[i].data.u32;
+
+            if (tag == WakeTag)
+            {
+                uint64_t value;
+                ssize_t drained = ::read(_wake, &value, sizeof(value));
+                (void)drained;
+                continue;
+            }
+
+            Entry& entry = _entries[tag];
+            if (!entry.control)
+                continue;
+
+            if (events[i].events & EPOLLOUT)
+                entry.port->sendPending();
+
+            // A vanished device would report readiness forever; leave it to the deadlines (heartbeat)
+            if (events[i].events & (EPOLLHUP | EPOLLERR))
+            {
+                watch(entry.fd, EPOLL_CTL_DEL, 0, tag);
+                entry.events = 0;
+            }
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                entry.ready = true;
+        }
+
+        now = millis();
+        int updated = 0;
+
+        for (uint8_t i = 0; i < EventLoopMaxDisplays; i++)
+        {
+            Entry& entry = _entries[i];
+
+            if (!entry.control)
+                continue;
+
+            if (!entry.ready && static_cast<long>(entry.control->nextDeadline(now) - now) > 0)
+                continue;
+
+            entry.ready = false;
+            entry.control->update(now);
+            updated++;
+        }
+
+        _updates += static_cast<uint32_t>(updated);
+        return updated;
+    }
+
+    /// @brief Run `runOnce()` until `stop()` is called.
+    void run()
+    {
+        _running.store(true);
+
+        while (_running.load(std::memory_order_relaxed))
+        {
+            if (runOnce() < 0)
+                break;
+        }
+    }
+
+    /// @brief Make `run()` return after the current pass (any thread).
+    void stop()
+    {
+        _running.store(false);
+        wake();
+    }
+
+    /// @brief Interrupt the current wait so deadlines are re-evaluated (any thread).
+    void wake()
+    {
+        uint64_t value = 1;
+        ssize_t written = ::write(_wake, &value, sizeof(value));
+        (void)written;
+    }
+
+    /// @brief Number of times the loop woke up.
+    uint32_t wakeupCount() const { return _wakeups; }
+
+    /// @brief Number of controller updates run.
+    uint32_t updateCount() const { return _updates; }
+
+private:
+    static const uint32_t WakeTag = 0xFFFFFFFFu;
+
+    struct Entry {
+        NextionControl* control;
+        NextionPosixSerial* port;
+        int fd;
+        uint32_t events;
+        bool ready;
+    };
+
+    bool watch(int fd, int operation, uint32_t events, uint32_t tag)
+    {
+        struct epoll_event event;
+        event.events = events;
+        event.data.u32 = tag;
+        return epoll_ctl(_epoll, operation, fd, &event) == 0;
+    }
+
+    int _epoll;
+    int _wake;
+    std::atomic<bool> _running;
+    uint32_t _wakeups;
+    uint32_t _updates;
+    Entry _entries[EventLoopMaxDisplays];
+
+    NextionEventLoop(const NextionEventLoop&) = delete;
+    NextionEventLoop& operator=(const NextionEventLoop&) = delete;
+};
+
+#endif
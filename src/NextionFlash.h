@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionFlash.h
+ * @brief Block writes of PROGMEM strings to a `Print`/`Stream`.
+ *
+ * `Print::print(const __FlashStringHelper*)` on AVR reads and writes flash
+ * strings one byte at a time, paying a virtual `write()` call per character.
+ * These helpers copy the string out of flash into a small stack buffer and
+ * hand each block to the port with a single `write(buffer, size)` call.
+ *
+ * On cores where flash is mapped into the data address space and PROGMEM is a
+ * no-op (ESP32, ARM Cortex-M, RP2040, ...) the copy is skipped entirely and the
+ * string is passed to `write()` in place.
+ */
+
+/**
+ * @def NEXTION_FLASH_MEMORY_MAPPED
+ * @brief Defined when PROGMEM data can be read with ordinary pointer access.
+ *
+ * Detected automatically; AVR (separate program space) and ESP8266 (flash
+ * requires aligned 32-bit reads) use the chunked copy path. Define it manually
+ * to force the zero-copy path, or define `NEXTION_FLASH_COPY` to force the
+ * chunked path on any core.
+ */
+#if !defined(NEXTION_FLASH_MEMORY_MAPPED) && !defined(NEXTION_FLASH_COPY)
+#if !defined(__AVR__) && !defined(ESP8266) && !defined(ARDUINO_ARCH_ESP8266)
+#define NEXTION_FLASH_MEMORY_MAPPED
+#endif
+#endif
+
+/// Size of the stack buffer used when copying PROGMEM strings to the port.
+const size_t FlashChunkSize = 16;
+
+/**
+ * @class NextionFlash
+ * @brief Static helpers for streaming flash-resident strings.
+ */
+class NextionFlash {
+public:
+    /**
+     * @brief Write a null-terminated PROGMEM string to a port in blocks.
+     *
+     * @param port Destination port.
+     * @param str  String stored in PROGMEM (may be nullptr).
+     * @return Number of bytes written.
+     */
+    static size_t write(Print* port, PGM_P str)
+    {
+        if (!port || !str)
+            return 0;
+
+#ifdef NEXTION_FLASH_MEMORY_MAPPED
+        return port->write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+#else
+        size_t remaining = strlen_P(str);
+        size_t written = 0;
+        char chunk[FlashChunkSize];
+
+        while (remaining > 0)
+        {
+            size_t blockSize = remaining < FlashChunkSize ? remaining : FlashChunkSize;
+            memcpy_P(chunk, str, blockSize);
+            written += port->write(reinterpret_cast<const uint8_t*>(chunk), blockSize);
+            str += blockSize;
+            remaining -= blockSize;
+        }
+
+        return written;
+#endif
+    }
+
+    /**
+     * @brief Write a string created with the F() macro to a port in blocks.
+     *
+     * @param port Destination port.
+     * @param str  String stored in PROGMEM (may be nullptr).
+     * @return Number of bytes written.
+     */
+    static size_t write(Print* port, const __FlashStringHelper* str)
+    {
+        return write(port, reinterpret_cast<PGM_P>(str));
+    }
+};
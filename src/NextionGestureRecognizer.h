@@ -0,0 +1,317 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionGestureRecognizer.h
+ * @brief Incremental tap, long-press, swipe and drag detection from XY touch events.
+ *
+ * With `sendxy=1` the display reports touch coordinates (0x67/0x68) on press,
+ * while moving and on release. `NextionGestureRecognizer` turns this stream into
+ * high-level `NextionGesture` events using a fixed amount of state (start point,
+ * last point, pending drag delta) instead of a point history:
+ * - `Tap`: released within `GestureDragSlop` of the start, before the long-press time.
+ * - `LongPress`: held within `GestureDragSlop` for `GestureLongPressTime`.
+ * - `Drag`: moved beyond `GestureDragSlop`; reports the movement since the last
+ *   `Drag`, at most once per `NextionControl::update()`.
+ * - `DragEnd`: released after dragging; reports the total movement.
+ * - `Swipe`: released after a quick, fast movement along one axis; reports the
+ *   direction and velocity. `Drag` events may precede it; it replaces `DragEnd`.
+ *
+ * Attach a recognizer to the controller; pages then receive gestures through
+ * `BaseDisplayPage::handleGesture()` instead of individual points through
+ * `handleTouchXY()`:
+ * @code
+ * NextionGestureRecognizer gestures;
+ *
+ * gestures.setSwipe(60, 300, 500);
+ * nextion.setGestureRecognizer(&gestures);
+ * @endcode
+ */
+
+/// Movement (pixels, along either axis) before a touch becomes a drag.
+const uint16_t GestureDragSlop = 8;
+
+/// Hold time (ms) for a long press.
+const uint16_t GestureLongPressTime = 600;
+
+/// Minimum movement (pixels, along the dominant axis) for a swipe.
+const uint16_t GestureSwipeMinDistance = 40;
+
+/// Maximum duration (ms) of a swipe.
+const uint16_t GestureSwipeMaxTime = 400;
+
+/// Minimum velocity (pixels per second, along the dominant axis) for a swipe.
+const uint16_t GestureSwipeMinVelocity = 300;
+
+/**
+ * @struct NextionGesture
+ * @brief One recognized gesture.
+ */
+struct NextionGesture {
+    /// @brief Gesture types.
+    enum Type : uint8_t {
+        Tap = 0,
+        LongPress = 1,
+        Swipe = 2,
+        Drag = 3,
+        DragEnd = 4
+    };
+
+    /// @brief Dominant direction of movement (screen coordinates, y grows downwards).
+    enum Direction : uint8_t {
+        None = 0,
+        Left = 1,
+        Right = 2,
+        Up = 3,
+        Down = 4
+    };
+
+    /// @brief One of `Type`.
+    uint8_t type;
+
+    /// @brief One of `Direction` (`None` for `Tap` and `LongPress`).
+    uint8_t direction;
+
+    /// @brief Start point for `Tap` and `LongPress`, current point otherwise.
+    uint16_t x;
+    uint16_t y;
+
+    /// @brief Movement since the previous `Drag` for `Drag`, since the press otherwise.
+    int16_t dx;
+    int16_t dy;
+
+    /// @brief Speed along the dominant axis (pixels per second); set for `Swipe` and `DragEnd`.
+    uint16_t velocity;
+
+    /// @brief Time since the press (ms, saturates at 65535).
+    uint16_t duration;
+};
+
+/**
+ * @class NextionGestureRecognizer
+ * @brief Constant-memory gesture state machine.
+ *
+ * RAM: 28 bytes (AVR).
+ */
+class NextionGestureRecognizer {
+public:
+    NextionGestureRecognizer()
+        : _slop(GestureDragSlop), _longPressTime(GestureLongPressTime),
+          _swipeDistance(GestureSwipeMinDistance), _swipeTime(GestureSwipeMaxTime),
+          _swipeVelocity(GestureSwipeMinVelocity)
+    {
+        reset();
+    }
+
+    /**
+     * @brief Set the drag and long-press thresholds.
+     * @param slop Movement (pixels) before a touch becomes a drag.
+     * @param longPressTime Hold time (ms) for a long press (0 = no long presses).
+     */
+    void setPress(uint16_t slop, uint16_t longPressTime)
+    {
+        _slop = slop;
+        _longPressTime = longPressTime;
+    }
+
+    /**
+     * @brief Set the swipe thresholds.
+     * @param minDistance Minimum movement (pixels) along the dominant axis.
+     * @param maxTime Maximum duration (ms) from press to release.
+     * @param minVelocity Minimum velocity (pixels per second).
+     */
+    void setSwipe(uint16_t minDistance, uint16_t maxTime, uint16_t minVelocity)
+    {
+        _swipeDistance = minDistance;
+        _swipeTime = maxTime;
+        _swipeVelocity = minVelocity;
+    }
+
+    /**
+     * @brief Process one XY touch event.
+     * @param x X coordinate.
+     * @param y Y coordinate.
+     * @param eventType `EventPress` (1) or `EventRelease` (0).
+     * @param now Current time in milliseconds.
+     * @param gesture Receives the gesture completed by this event, if any.
+     * @return true if `gesture` was filled (only on release).
+     */
+    bool feed(uint16_t x, uint16_t y, uint8_t eventType, unsigned long now, NextionGesture& gesture)
+    {
+        if (eventType != 0)
+        {
+            if (_state == Idle)
+            {
+                _state = Pressed;
+                _startX = _lastX = x;
+                _startY = _lastY = y;
+                _startTime = now;
+                _dragX = _dragY = 0;
+                return false;
+            }
+
+            move(x, y);
+            return false;
+        }
+
+        if (_state == Idle)
+            return false;
+
+        // The release carries the final position
+        move(x, y);
+
+        State state = _state;
+        _state = Idle;
+
+        int16_t dx = static_cast<int16_t>(x - _startX);
+        int16_t dy = static_cast<int16_t>(y - _startY);
+        uint16_t distance = dominant(dx, dy);
+        unsigned long elapsed = now - _startTime;
+        unsigned long speed = static_cast<unsigned long>(distance) * 1000UL / (elapsed > 0 ? elapsed : 1);
+        uint16_t velocity = static_cast<uint16_t>(speed < 0xFFFFUL ? speed : 0xFFFFUL);
+
+        if (distance >= _swipeDistance && elapsed <= _swipeTime && velocity >= _swipeVelocity)
+        {
+            fill(gesture, NextionGesture::Swipe, x, y, dx, dy, now);
+            gesture.velocity = velocity;
+            return true;
+        }
+
+        if (state == Dragging)
+        {
+            fill(gesture, NextionGesture::DragEnd, x, y, dx, dy, now);
+            gesture.velocity = velocity;
+            return true;
+        }
+
+        // A long press has already been reported
+        if (state == Held)
+            return false;
+
+        fill(gesture, NextionGesture::Tap, _startX, _startY, 0, 0, now);
+        gesture.direction = NextionGesture::None;
+        return true;
+    }
+
+    /**
+     * @brief Report time-based gestures and pending drag movement.
+     *
+     * Call once per update pass, after the received events have been fed.
+     * @param now Current time in milliseconds.
+     * @param gesture Receives a `LongPress` or `Drag`, if due.
+     * @return true if `gesture` was filled.
+     */
+    bool poll(unsigned long now, NextionGesture& gesture)
+    {
+        if (_state == Pressed && _longPressTime > 0 && (now - _startTime) >= _longPressTime)
+        {
+            _state = Held;
+            fill(gesture, NextionGesture::LongPress, _startX, _startY, 0, 0, now);
+            gesture.direction = NextionGesture::None;
+            return true;
+        }
+
+        if (_state == Dragging && (_dragX != 0 || _dragY != 0))
+        {
+            fill(gesture, NextionGesture::Drag, _lastX, _lastY, _dragX, _dragY, now);
+            _dragX = _dragY = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Time a long press becomes due, for event loops that sleep between updates.
+     * @param due Receives the time in milliseconds.
+     * @return false if no time-based gesture is pending.
+     */
+    bool nextDeadline(unsigned long& due) const
+    {
+        if (_state != Pressed || _longPressTime == 0)
+            return false;
+
+        due = _startTime + _longPressTime;
+        return true;
+    }
+
+    /// @brief true while a finger is down.
+    bool isActive() const { return _state != Idle; }
+
+    /// @brief Abandon the current gesture (e.g. after a display restart).
+    void reset()
+    {
+        _state = Idle;
+        _dragX = _dragY = 0;
+    }
+
+private:
+    enum State : uint8_t {
+        Idle = 0,
+        Pressed = 1,
+        Held = 2,
+        Dragging = 3
+    };
+
+    void move(uint16_t x, uint16_t y)
+    {
+        if (_state != Dragging)
+        {
+            int16_t dx = static_cast<int16_t>(x - _startX);
+            int16_t dy = static_cast<int16_t>(y - _startY);
+
+            if (dominant(dx, dy) <= _slop)
+                return;
+
+            // The first drag reports the movement since the press
+            _state = Dragging;
+            _lastX = _startX;
+            _lastY = _startY;
+        }
+
+        _dragX += static_cast<int16_t>(x - _lastX);
+        _dragY += static_cast<int16_t>(y - _lastY);
+        _lastX = x;
+        _lastY = y;
+    }
+
+    void fill(NextionGesture& gesture, uint8_t type, uint16_t x, uint16_t y, int16_t dx, int16_t dy, unsigned long now) const
+    {
+        unsigned long elapsed = now - _startTime;
+
+        gesture.type = type;
+        gesture.x = x;
+        gesture.y = y;
+        gesture.dx = dx;
+        gesture.dy = dy;
+        gesture.velocity = 0;
+        gesture.duration = static_cast<uint16_t>(elapsed < 0xFFFFUL ? elapsed : 0xFFFFUL);
+
+        if (abs(dx) >= abs(dy))
+            gesture.direction = dx > 0 ? NextionGesture::Right : (dx < 0 ? NextionGesture::Left : NextionGesture::None);
+        else
+            gesture.direction = dy > 0 ? NextionGesture::Down : NextionGesture::Up;
+    }
+
+    static uint16_t dominant(int16_t dx, int16_t dy)
+    {
+        uint16_t ax = static_cast<uint16_t>(dx < 0 ? -dx : dx);
+        uint16_t ay = static_cast<uint16_t>(dy < 0 ? -dy : dy);
+        return ax > ay ? ax : ay;
+    }
+
+    uint16_t _slop;
+    uint16_t _longPressTime;
+    uint16_t _swipeDistance;
+    uint16_t _swipeTime;
+    uint16_t _swipeVelocity;
+    uint16_t _startX;
+    uint16_t _startY;
+    uint16_t _lastX;
+    uint16_t _lastY;
+    int16_t _dragX;
+    int16_t _dragY;
+    unsigned long _startTime;
+    State _state;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionHash.h
+ * @brief FNV-1a hashing and per-component text change detection.
+ *
+ * Caching the full text of every text component to suppress redundant sends
+ * costs more RAM than small boards have. Instead a `NextionTextHash` slot keeps
+ * a 16-bit FNV-1a hash of the last text sent to one component (7 bytes per
+ * component on AVR) and the `sendText` overloads taking a slot skip the send when the
+ * hash is unchanged. The hash is computed in the same loop that measures the
+ * text for its block write, so it adds almost nothing to the send cost.
+ */
+
+/// FNV-1a 32-bit offset basis.
+const uint32_t HashSeed = 2166136261UL;
+
+/// FNV-1a 32-bit prime.
+const uint32_t HashPrime = 16777619UL;
+
+/// Default number of consecutive skipped sends after which a text is re-sent
+/// anyway, guarding against hash collisions and display-side corruption.
+const uint8_t TextHashForceAfter = 30;
+
+/**
+ * @class NextionHash
+ * @brief Static FNV-1a helpers.
+ */
+class NextionHash {
+public:
+    /// @brief Mix one byte into a running hash.
+    static uint32_t update(uint32_t hash, uint8_t value)
+    {
+        return (hash ^ value) * HashPrime;
+    }
+
+    /**
+     * @brief Hash a null-terminated string and measure it in one pass.
+     * @param text Null-terminated string in RAM.
+     * @param length Receives the string length (as `strlen`).
+     * @return 32-bit FNV-1a hash of the string.
+     */
+    static uint32_t text(const char* text, size_t& length)
+    {
+        uint32_t hash = HashSeed;
+        const char* p = text;
+
+        while (*p)
+            hash = update(hash, static_cast<uint8_t>(*p++));
+
+        length = static_cast<size_t>(p - text);
+        return hash;
+    }
+
+    /// @brief Fold a 32-bit hash to 16 bits for compact storage.
+    static uint16_t fold(uint32_t hash)
+    {
+        return static_cast<uint16_t>(hash ^ (hash >> 16));
+    }
+};
+
+/**
+ * @class NextionTextHash
+ * @brief Last-sent state for one text component (7 bytes on AVR).
+ *
+ * Declare one per text component, typically as a page member, and pass it to
+ * the `sendText` overloads taking a slot. The slot also records the page's state
+ * generation, so all texts are re-sent automatically after the page is
+ * re-entered and the display has reset them to their HMI defaults. The
+ * generation is 32 bits wide so that it cannot wrap back to a slot's stale
+ * value within the life of a device.
+ */
+class NextionTextHash {
+    friend class BaseDisplayPage;
+    friend class NextionWidget;
+
+public:
+    NextionTextHash() : _generation(0), _hash(0), _skips(Invalid) {}
+
+    /// @brief Forget the last-sent text so the next send goes out unconditionally.
+    void reset() { _skips = Invalid; }
+
+    /// @brief Largest usable `forceAfter`; larger values are clamped to it.
+    static const uint8_t MaxForceAfter = 254;
+
+private:
+    /// @brief Marker in `_skips` for a slot with no valid last-sent text.
+    static const uint8_t Invalid = 0xFF;
+
+    /**
+     * @brief Decide whether a text must be sent, updating the slot if so.
+     * @param hash Folded hash of the text about to be sent.
+     * @param generation Current state generation of the owning page.
+     * @param forceAfter Re-send after this many consecutive skips (0 = never force,
+     *                   clamped to `MaxForceAfter`).
+     * @return true if the text must be sent.
+     */
+    bool changed(uint16_t hash, uint32_t generation, uint8_t forceAfter)
+    {
+        // The skip counter shares its top value with the Invalid marker
+        if (forceAfter > MaxForceAfter)
+            forceAfter = MaxForceAfter;
+
+        if (_skips != Invalid && _generation == generation && _hash == hash &&
+            (forceAfter == 0 || _skips < forceAfter))
+        {
+            if (_skips < MaxForceAfter)
+                _skips++;
+
+            return false;
+        }
+
+        _hash = hash;
+        _generation = generation;
+        _skips = 0;
+        return true;
+    }
+
+    uint32_t _generation;
+    uint16_t _hash;
+    uint8_t _skips;
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * @file NextionHeapGuard.h
+ * @brief Allocation accounting hook for host test builds.
+ *
+ * When `NEXTION_HEAP_GUARD` is defined, `NextionControl::update()` opens a
+ * `NextionHeapGuard::Scope` for its whole duration. Any allocation reported via
+ * `NextionHeapGuard::recordAllocation()` while a scope is open is counted as a
+ * violation, and the violation callback is invoked (or the process aborts if no
+ * callback has been set).
+ *
+ * The library never replaces the global allocator by itself. A host test opts in
+ * by expanding `NEXTION_HEAP_GUARD_INSTALL()` in exactly one translation unit,
+ * which defines replacement `operator new`/`operator new[]` (and, on glibc,
+ * `malloc`) that report to the guard:
+ *
+ * `NEXTION_HEAP_GUARD` must be defined for the whole build (`-DNEXTION_HEAP_GUARD`),
+ * so that `NextionControl.cpp` is compiled with the scope too:
+ *
+ * @code
+ * #include <NextionControl.h>
+ *
+ * NEXTION_HEAP_GUARD_INSTALL()
+ *
+ * // ... drive the controller to steady state, then:
+ * NextionHeapGuard::reset();
+ * nextion.update(now);
+ * assert(NextionHeapGuard::violationCount() == 0);
+ * @endcode
+ *
+ * @note Intended for host (Linux) builds only; on target hardware this header is
+ *       not included unless `NEXTION_HEAP_GUARD` is defined.
+ */
+class NextionHeapGuard {
+public:
+    /// @brief Callback invoked for each allocation made while a scope is open.
+    typedef void (*ViolationCallback)(size_t size);
+
+    /**
+     * @class Scope
+     * @brief RAII marker for a region that must not allocate. Scopes may nest.
+     */
+    class Scope {
+    public:
+        Scope() { state().depth++; }
+        ~Scope() { state().depth--; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /// @brief true while at least one `Scope` is open.
+    static bool active() { return state().depth > 0; }
+
+    /**
+     * @brief Report an allocation to the guard.
+     *
+     * Called by the replacement allocators defined by `NEXTION_HEAP_GUARD_INSTALL()`.
+     * Allocations outside a scope are counted but are not violations.
+     *
+     * @param size Requested allocation size in bytes.
+     */
+    static void recordAllocation(size_t size)
+    {
+        State& s = state();
+        s.allocations++;
+
+        if (s.depth == 0 || s.reporting)
+            return;
+
+        s.violations++;
+
+        // Guard against re-entry if the callback itself allocates
+        s.reporting = true;
+        if (s.callback)
+            s.callback(size);
+        else
+            abort();
+        s.reporting = false;
+    }
+
+    /// @brief Total allocations reported since the last `reset()`.
+    static uint32_t allocationCount() { return state().allocations; }
+
+    /// @brief Allocations reported inside a scope since the last `reset()`.
+    static uint32_t violationCount() { return state().violations; }
+
+    /// @brief Clear the allocation and violation counters.
+    static void reset()
+    {
+        state().allocations = 0;
+        state().violations = 0;
+    }
+
+    /**
+     * @brief Set the violation callback.
+     * @param callback Function to call for each violation, or nullptr to abort instead.
+     */
+    static void setViolationCallback(ViolationCallback callback) { state().callback = callback; }
+
+private:
+    struct State {
+        int depth;
+        bool reporting;
+        uint32_t allocations;
+        uint32_t violations;
+        ViolationCallback callback;
+    };
+
+    static State& state()
+    {
+        static State s = { 0, false, 0, 0, nullptr };
+        return s;
+    }
+};
+
+#if defined(__GLIBC__)
+extern "C" void* __libc_malloc(size_t size);
+
+#define NEXTION_HEAP_GUARD_RAW_MALLOC(size) __libc_malloc(size)
+
+#define NEXTION_HEAP_GUARD_INSTALL_MALLOC() \
+    extern "C" void* malloc(size_t size) \
+    { \
+        NextionHeapGuard::recordAllocation(size); \
+        return __libc_malloc(size); \
+    }
+#else
+#define NEXTION_HEAP_GUARD_RAW_MALLOC(size) malloc(size)
+#define NEXTION_HEAP_GUARD_INSTALL_MALLOC()
+#endif
+
+/**
+ * @def NEXTION_HEAP_GUARD_INSTALL
+ * @brief Define replacement allocators that report to `NextionHeapGuard`.
+ *
+ * Expand once, at namespace scope, in a single host test translation unit.
+ */
+#define NEXTION_HEAP_GUARD_INSTALL() \
+    NEXTION_HEAP_GUARD_INSTALL_MALLOC() \
+    void* operator new(size_t size) \
+    { \
+        NextionHeapGuard::recordAllocation(size); \
+        void* p = NEXTION_HEAP_GUARD_RAW_MALLOC(size ? size : 1); \
+        if (!p) \
+            abort(); \
+        return p; \
+    } \
+    void* operator new[](size_t size) \
+    { \
+        return operator new(size); \
+    } \
+    void operator delete(void* p) noexcept { free(p); } \
+    void operator delete[](void* p) noexcept { free(p); } \
+    void operator delete(void* p, size_t) noexcept { free(p); } \
+    void operator delete[](void* p, size_t) noexcept { free(p); }
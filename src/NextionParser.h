@@ -0,0 +1,310 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionParser.h
+ * @brief Reusable frame assembler for the Nextion serial protocol.
+ *
+ * Both directions of the Nextion link use the same framing: a payload followed
+ * by 0xFF 0xFF 0xFF. `NextionParser` assembles frames one byte at a time into its
+ * own buffer, skipping stray leading 0xFF bytes. The same code drives
+ * `NextionControl` (display to host) and `NextionSniffer` (both directions).
+ *
+ * With return framing enabled (display to host), the parser also uses the
+ * known lengths of the standard return codes (see `returnLength()`):
+ * - 0xFF bytes inside a fixed-length payload are data, so `71 FF FF FF FF`
+ *   (the number -1) is no longer cut short.
+ * - A damaged terminator after a complete payload still yields the frame, and
+ *   the unexpected byte starts the next one, so no good data is lost.
+ * - After a framing error, bytes that cannot start a return are discarded
+ *   until a plausible header is found.
+ * - A stalled partial frame can be salvaged with `expire()` if its payload is complete.
+ * `resyncCount()` and `discardedCount()` report how often this happened.
+ *
+ * @code
+ * NextionParser<64> parser;
+ *
+ * while (port.available() > 0)
+ * {
+ *     if (parser.feed(port.read()) == NextionParserBase::Frame)
+ *         handle(parser.frame(), parser.length());
+ * }
+ * @endcode
+ */
+
+/**
+ * @class NextionParserBase
+ * @brief Capacity-independent part of a frame assembler.
+ *
+ * Storage is supplied by `NextionParser`.
+ */
+class NextionParserBase {
+public:
+    /// @brief Result of feeding one byte.
+    enum Result : uint8_t {
+        /// Byte stored; the frame is not complete yet.
+        Pending = 0,
+        /// Stray 0xFF before a frame, or noise discarded while resynchronising; ignored.
+        Skipped = 1,
+        /// A frame is complete: see `frame()` and `length()`.
+        Frame = 2,
+        /// The frame did not fit in the buffer and was discarded.
+        Overflow = 3
+    };
+
+    /// `returnLength()` of codes whose length is not fixed (0x70 strings, 0x00 startup).
+    static const uint8_t VariableLength = 0;
+
+    /// `returnLength()` of bytes that are not a standard return code.
+    static const uint8_t InvalidHeader = 0xFF;
+
+    /**
+     * @brief Frame length of a standard return code, header included.
+     * @param header First byte of a display-to-host frame.
+     * @return Length, `VariableLength` or `InvalidHeader`.
+     */
+    static uint8_t returnLength(uint8_t header)
+    {
+        // 0x00 is both "invalid instruction" and the first byte of the 00 00 00 startup frame
+        if (header == 0x00)
+            return VariableLength;
+
+        // Instruction result and error codes
+        if (header <= 0x24)
+            return 1;
+
+        switch (header)
+        {
+            case 0x65: return 4;  // Touch event
+            case 0x66: return 2;  // Current page
+            case 0x67:            // Touch coordinates
+            case 0x68: return 6;
+            case 0x70: return VariableLength;  // String
+            case 0x71: return 5;  // Number
+            case 0x86:            // Sleep, wake, ready, upgrade
+            case 0x87:
+            case 0x88:
+            case 0x89:
+            case 0xFD:            // Transparent data
+            case 0xFE: return 1;
+            default: return InvalidHeader;
+        }
+    }
+
+    /**
+     * @brief true if a display-to-host frame is the 00 00 00 a panel sends at power-on or after a reset.
+     *
+     * The startup frame and the 1-byte "invalid instruction" return share the
+     * 0x00 header; only the payload length tells them apart.
+     * @param frame Payload without the terminator.
+     * @param length Payload length.
+     */
+    static bool isStartupFrame(const uint8_t* frame, size_t length)
+    {
+        return length == 3 && frame[0] == 0x00 && frame[1] == 0x00 && frame[2] == 0x00;
+    }
+
+    /**
+     * @brief Use the known lengths of display return codes (display-to-host direction only).
+     * @param enabled true to enable length-aware framing and resynchronisation.
+     */
+    void setReturnFraming(bool enabled) { _returnFraming = enabled; }
+
+    /**
+     * @brief Add one received byte.
+     * @param value Received byte.
+     * @return What the byte did to the frame being assembled.
+     */
+    Result feed(uint8_t value)
+    {
+        // Byte that broke the previous frame's terminator: it starts this one
+        if (_hasCarry)
+        {
+            _hasCarry = false;
+            start(_carry);
+        }
+
+        if (!_receiving)
+        {
+            // Skip leading 0xFF bytes (noise or the tail of an incomplete terminator)
+            if (value == 0xFF)
+                return Skipped;
+
+            return start(value) ? Pending : Skipped;
+        }
+
+        if (_position >= _capacity)
+        {
+            _discarded += _position;
+            _resyncs++;
+            _syncLost = true;
+            reset();
+            return Overflow;
+        }
+
+        // Fixed-length payload: 0xFF is data, not a terminator
+        if (_position < _expected)
+        {
+            _buffer[_position++] = value;
+            return Pending;
+        }
+
+        if (value == 0xFF)
+        {
+            _buffer[_position++] = value;
+
+            if (++_terminatorCount < 3)
+                return Pending;
+
+            _length = _position - 3;
+            _syncLost = false;
+            finish();
+            return Frame;
+        }
+
+        if (_expected > 0)
+        {
+            // Damaged terminator after a complete payload: deliver it and re-align
+            _length = _expected;
+            _carry = value;
+            _hasCarry = true;
+            _resyncs++;
+            _syncLost = true;
+            finish();
+            return Frame;
+        }
+
+        _buffer[_position++] = value;
+        _terminatorCount = 0;
+        return Pending;
+    }
+
+    /**
+     * @brief Give up on a stalled partial frame.
+     *
+     * With return framing, a partial frame whose fixed-length payload is
+     * complete (only the terminator is missing) is delivered; otherwise its
+     * bytes are discarded and the parser resynchronises on the next plausible header.
+     * @return `Frame` if a frame was salvaged (see `frame()`), else `Skipped`.
+     */
+    Result expire()
+    {
+        if (!isReceiving())
+            return Skipped;
+
+        if (_hasCarry)
+        {
+            _hasCarry = false;
+            _discarded++;
+        }
+        else if (_receiving && _expected > 0 && _position >= _expected)
+        {
+            _length = _expected;
+            _resyncs++;
+            finish();
+            return Frame;
+        }
+        else
+        {
+            _discarded += _position;
+        }
+
+        _resyncs++;
+        _syncLost = true;
+        reset();
+        return Skipped;
+    }
+
+    /// @brief Payload of the last complete frame (valid until the next `feed()`).
+    const uint8_t* frame() const { return _buffer; }
+
+    /// @brief Length of the last complete frame, terminator excluded.
+    size_t length() const { return _length; }
+
+    /// @brief true while a frame is partly assembled.
+    bool isReceiving() const { return _receiving || _hasCarry; }
+
+    /// @brief Number of bytes of the partly assembled frame.
+    size_t received() const { return _receiving ? _position : (_hasCarry ? 1 : 0); }
+
+    /// @brief First byte of the partly assembled frame (valid while `isReceiving()`).
+    uint8_t header() const { return _hasCarry ? _carry : _buffer[0]; }
+
+    /// @brief Number of framing errors recovered from (damaged terminators, expired frames, overflows).
+    uint32_t resyncCount() const { return _resyncs; }
+
+    /// @brief Number of received bytes that were not delivered in a frame.
+    uint32_t discardedCount() const { return _discarded; }
+
+    /// @brief Abandon a partly assembled frame.
+    void reset()
+    {
+        _receiving = false;
+        _hasCarry = false;
+        _terminatorCount = 0;
+        _position = 0;
+    }
+
+protected:
+    NextionParserBase(uint8_t* buffer, size_t capacity)
+        : _buffer(buffer), _capacity(capacity), _position(0), _length(0),
+          _resyncs(0), _discarded(0), _expected(0), _terminatorCount(0), _carry(0),
+          _receiving(false), _hasCarry(false), _returnFraming(false), _syncLost(false) {}
+
+private:
+    /// @brief Begin a frame with its first byte; false if it was discarded while resynchronising.
+    bool start(uint8_t value)
+    {
+        uint8_t length = _returnFraming ? returnLength(value) : VariableLength;
+
+        if (_syncLost && length == InvalidHeader)
+        {
+            _discarded++;
+            return false;
+        }
+
+        _expected = length == InvalidHeader ? 0 : length;
+        _terminatorCount = 0;
+        _buffer[0] = value;
+        _position = 1;
+        _receiving = true;
+        return true;
+    }
+
+    void finish()
+    {
+        _receiving = false;
+        _terminatorCount = 0;
+        _position = 0;
+    }
+
+    uint8_t* _buffer;
+    size_t _capacity;
+    size_t _position;
+    size_t _length;
+    uint32_t _resyncs;
+    uint32_t _discarded;
+    uint8_t _expected;
+    uint8_t _terminatorCount;
+    uint8_t _carry;
+    bool _receiving;
+    bool _hasCarry;
+    bool _returnFraming;
+    bool _syncLost;
+};
+
+/**
+ * @class NextionParser
+ * @brief Frame assembler with inline storage.
+ *
+ * @tparam Capacity Largest frame, terminator included.
+ */
+template <size_t Capacity>
+class NextionParser : public NextionParserBase {
+public:
+    NextionParser() : NextionParserBase(_storage, Capacity) {}
+
+private:
+    uint8_t _storage[Capacity];
+};
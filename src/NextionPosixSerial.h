@@ -0,0 +1,380 @@
+#pragma once
+
+#include <Arduino.h>
+#include "NextionControl.h"
+
+/**
+ * @file NextionPosixSerial.h
+ * @brief `Stream` on a POSIX tty, for Linux single-board computers.
+ *
+ * `NextionControl` only needs a `Stream`; on a Raspberry Pi-class controller
+ * `NextionPosixSerial` provides one over a serial device (`/dev/ttyAMA0`,
+ * `/dev/ttyUSB0`, ...):
+ * - The tty is opened non-blocking and set to raw 8N1 with termios, so neither
+ *   `update()` nor a write ever waits on the kernel except when the transmit
+ *   buffer is full.
+ * - Reads fetch up to `PosixSerialBufferSize` bytes per system call. The port
+ *   is a `NextionBufferedStream`, so the controller parses straight from that
+ *   buffer instead of calling `available()`/`read()` per byte.
+ * - Writes are collected and handed to the kernel in one system call per
+ *   complete command (at its `FF FF FF` terminator), or when the buffer fills.
+ *
+ * @code
+ * NextionPosixSerial port;
+ * NextionControl nextion(&port, pages, pageCount);
+ *
+ * int main()
+ * {
+ *     if (!port.open("/dev/ttyUSB0", 115200))
+ *         return 1;
+ *
+ *     nextion.begin();
+ *     for (;;)
+ *     {
+ *         nextion.update(millis());
+ *         usleep(1000);
+ *     }
+ * }
+ * @endcode
+ *
+ * `attach()` takes an already open descriptor instead, e.g. one side of a
+ * pseudo-terminal pair connected to a simulated display in tests. `fd()`
+ * gives the descriptor for `poll()`/`epoll` readiness.
+ *
+ * Available on POSIX hosts (`NEXTION_POSIX_SERIAL` is then defined).
+ */
+
+#if (defined(__unix__) || defined(__APPLE__)) && defined(__has_include)
+#if __has_include(<termios.h>) && __has_include(<poll.h>)
+#define NEXTION_POSIX_SERIAL 1
+#endif
+#endif
+
+#ifdef NEXTION_POSIX_SERIAL
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+/// Size of the receive and of the transmit buffer in bytes.
+const size_t PosixSerialBufferSize = 4096;
+
+/**
+ * @class NextionPosixSerial
+ * @brief Non-blocking, buffered `Stream` on a tty file descriptor.
+ */
+class NextionPosixSerial : public NextionBufferedStream {
+public:
+    NextionPosixSerial()
+        : _fd(-1), _owned(false), _error(0), _rxStart(0), _rxEnd(0), _txStart(0), _txEnd(0) {}
+
+    ~NextionPosixSerial() { close(); }
+
+    /**
+     * @brief Open and configure a serial device.
+     * @param path Device path (e.g. "/dev/ttyUSB0").
+     * @param baud Baud rate; must be a standard rate.
+     * @return false on failure (`error()` gives the errno value).
+     */
+    bool open(const char* path, unsigned long baud)
+    {
+        close();
+
+        speed_t speed = speedFor(baud);
+        if (speed == B0)
+            return fail(EINVAL);
+
+        int fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+            return fail(errno);
+
+        struct termios options;
+
+        if (tcgetattr(fd, &options) != 0)
+        {
+            int error = errno;
+            ::close(fd);
+            return fail(error);
+        }
+
+        // Raw 8N1 without flow control; reads return what is there
+        cfmakeraw(&options);
+        options.c_cflag |= CLOCAL | CREAD;
+        options.c_cflag &= ~CSTOPB;
+#ifdef CRTSCTS
+        options.c_cflag &= ~CRTSCTS;
+#endif
+        options.c_cc[VMIN] = 0;
+        options.c_cc[VTIME] = 0;
+        cfsetispeed(&options, speed);
+        cfsetospeed(&options, speed);
+
+        if (tcsetattr(fd, TCSANOW, &options) != 0)
+        {
+            int error = errno;
+            ::close(fd);
+            return fail(error);
+        }
+
+        tcflush(fd, TCIOFLUSH);
+
+        _fd = fd;
+        _owned = true;
+        _error = 0;
+        return true;
+    }
+
+    /**
+     * @brief Use an already open descriptor (e.g. a pseudo-terminal); it is set non-blocking.
+     * @param fd Descriptor; not closed by `close()`.
+     * @return false if the descriptor is invalid.
+     */
+    bool attach(int fd)
+    {
+        close();
+
+        int flags = fcntl(fd, F_GETFL);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+            return fail(errno);
+
+        _fd = fd;
+        _owned = false;
+        _error = 0;
+        return true;
+    }
+
+    /// @brief Send pending bytes and close the device (an attached descriptor is only released).
+    void close()
+    {
+        if (_fd < 0)
+            return;
+
+        flush();
+
+        if (_owned)
+            ::close(_fd);
+
+        _fd = -1;
+        _rxStart = _rxEnd = 0;
+        _txStart = _txEnd = 0;
+    }
+
+    /// @brief true while a device is open or attached.
+    bool isOpen() const { return _fd >= 0; }
+
+    /// @brief Descriptor, for readiness notification; -1 when closed.
+    int fd() const { return _fd; }
+
+    /// @brief errno value of the last failed operation (0 if none).
+    int error() const { return _error; }
+
+    /// @brief true if bytes are waiting to be handed to the kernel.
+    bool hasPendingOutput() const { return _txEnd > _txStart; }
+
+    int available() override
+    {
+        return static_cast<int>(fill());
+    }
+
+    int read() override
+    {
+        if (fill() == 0)
+            return -1;
+
+        return _rx[_rxStart++];
+    }
+
+    int peek() override
+    {
+        return fill() > 0 ? _rx[_rxStart] : -1;
+    }
+
+    size_t receiveBlock(const uint8_t*& data) override
+    {
+        size_t length = fill();
+        data = _rx + _rxStart;
+        return length;
+    }
+
+    void consumeBlock(size_t length) override
+    {
+        _rxStart += length;
+    }
+
+    size_t write(uint8_t value) override
+    {
+        return write(&value, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override
+    {
+        if (_fd < 0)
+            return 0;
+
+        size_t written = 0;
+
+        while (written < size)
+        {
+            if (_txEnd == PosixSerialBufferSize && !makeRoom())
+                break;
+
+            size_t count = PosixSerialBufferSize - _txEnd;
+            if (count > size - written)
+                count = size - written;
+
+            memcpy(_tx + _txEnd, buffer + written, count);
+            _txEnd += count;
+            written += count;
+        }
+
+        // A complete command goes to the kernel straight away
+        if (terminated())
+            sendPending();
+
+        return written;
+    }
+
+    using Print::write;
+
+    int availableForWrite() override
+    {
+        return static_cast<int>(PosixSerialBufferSize - (_txEnd - _txStart));
+    }
+
+    /// @brief Hand all pending bytes to the kernel, waiting up to `SerialTimeout` ms for room.
+    void flush() override
+    {
+        while (hasPendingOutput() && sendPending() && waitWritable()) {}
+    }
+
+    /**
+     * @brief Hand buffered output to the kernel without waiting (e.g. when the device becomes writable).
+     * @return false if the device failed (pending output is dropped).
+     */
+    bool sendPending()
+    {
+        while (_txStart < _txEnd)
+        {
+            ssize_t count = ::write(_fd, _tx + _txStart, _txEnd - _txStart);
+
+            if (count > 0)
+            {
+                _txStart += static_cast<size_t>(count);
+                continue;
+            }
+
+            if (count < 0 && errno == EINTR)
+                continue;
+
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return true;
+
+            _error = count < 0 ? errno : EIO;
+            _txStart = _txEnd = 0;
+            return false;
+        }
+
+        _txStart = _txEnd = 0;
+        return true;
+    }
+
+private:
+    static speed_t speedFor(unsigned long baud)
+    {
+        switch (baud)
+        {
+            case 9600: return B9600;
+            case 19200: return B19200;
+            case 38400: return B38400;
+            case 57600: return B57600;
+            case 115200: return B115200;
+            case 230400: return B230400;
+#ifdef B460800
+            case 460800: return B460800;
+#endif
+#ifdef B921600
+            case 921600: return B921600;
+#endif
+            default: return B0;
+        }
+    }
+
+    bool fail(int error)
+    {
+        _error = error;
+        return false;
+    }
+
+    /// @brief Buffered received bytes, reading from the device once the buffer is empty.
+    size_t fill()
+    {
+        if (_rxStart < _rxEnd)
+            return _rxEnd - _rxStart;
+
+        _rxStart = _rxEnd = 0;
+
+        if (_fd < 0)
+            return 0;
+
+        ssize_t count = ::read(_fd, _rx, PosixSerialBufferSize);
+
+        if (count > 0)
+            _rxEnd = static_cast<size_t>(count);
+        else if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            _error = errno;
+
+        return _rxEnd;
+    }
+
+    /// @brief true if the buffered output ends with a command terminator.
+    bool terminated() const
+    {
+        return _txEnd - _txStart >= 3 && _tx[_txEnd - 1] == 0xFF && _tx[_txEnd - 2] == 0xFF && _tx[_txEnd - 3] == 0xFF;
+    }
+
+    /// @brief Free space at the end of the transmit buffer; false if the device stays full.
+    bool makeRoom()
+    {
+        while (sendPending() && _txStart == 0 && _txEnd == PosixSerialBufferSize)
+        {
+            if (!waitWritable())
+                return false;
+        }
+
+        if (_txStart > 0)
+        {
+            memmove(_tx, _tx + _txStart, _txEnd - _txStart);
+            _txEnd -= _txStart;
+            _txStart = 0;
+        }
+
+        return _txEnd < PosixSerialBufferSize;
+    }
+
+    /// @brief Wait until the device accepts output; false after `SerialTimeout` ms.
+    bool waitWritable()
+    {
+        struct pollfd descriptor = { _fd, POLLOUT, 0 };
+        int ready = ::poll(&descriptor, 1, static_cast<int>(SerialTimeout));
+
+        if (ready > 0 && !(descriptor.revents & (POLLERR | POLLHUP | POLLNVAL)))
+            return true;
+
+        _error = ready == 0 ? ETIMEDOUT : (ready < 0 ? errno : EIO);
+        return false;
+    }
+
+    int _fd;
+    bool _owned;
+    int _error;
+    size_t _rxStart;
+    size_t _rxEnd;
+    size_t _txStart;
+    size_t _txEnd;
+    uint8_t _rx[PosixSerialBufferSize];
+    uint8_t _tx[PosixSerialBufferSize];
+};
+
+#endif
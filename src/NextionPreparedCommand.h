@@ -0,0 +1,211 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionPreparedCommand.h
+ * @brief Pre-encoded command templates with in-place value patching.
+ *
+ * Refresh loops send the same command shapes thousands of times per hour, e.g.
+ * `n3.val=` followed by a number and the 0xFF 0xFF 0xFF terminator. A prepared
+ * command encodes the constant parts once into its own buffer, leaving a slot
+ * for a numeric or text value:
+ *
+ *     [prefix][slot][suffix][FF FF FF]
+ *
+ * Each send only formats the slot bytes in place (the suffix and terminator are
+ * re-appended only when the slot length changes) and the whole command is
+ * handed to the port in a single `write()` call, instead of the five or six
+ * `print()`/`write()` calls made by the generic helpers.
+ *
+ * On AVR, `F()` only compiles inside a function, so templates are typically
+ * page members built in the page's constructor:
+ * @code
+ * class EnginePage : public BaseDisplayPage {
+ * public:
+ *     explicit EnginePage(Stream* port)
+ *         : BaseDisplayPage(port), rpmCommand(F("n3.val=")), statusCommand(F("t0.txt=\""), F("\"")) {}
+ *
+ *     void refresh(unsigned long now) override
+ *     {
+ *         sendPrepared(rpmCommand, rpm);
+ *         sendPrepared(statusCommand, statusText);
+ *     }
+ *
+ * private:
+ *     NextionPreparedCommand<16> rpmCommand;
+ *     NextionPreparedCommand<40> statusCommand;
+ * };
+ * @endcode
+ */
+
+/// Number of 0xFF bytes terminating every Nextion command.
+const uint8_t CommandTerminatorLength = 3;
+
+/**
+ * @class NextionPreparedCommandBase
+ * @brief Capacity-independent part of a prepared command.
+ *
+ * Holds the buffer bookkeeping; storage is supplied by `NextionPreparedCommand`.
+ * Pages and the controller accept references to this type so templates of any
+ * capacity can be sent through the same helpers.
+ */
+class NextionPreparedCommandBase {
+public:
+    /**
+     * @brief Format a numeric value into the slot.
+     * @param value Value to place in the slot.
+     * @return Total command length including terminator, or 0 if the template is invalid.
+     */
+    size_t format(int32_t value)
+    {
+        if (!_valid)
+            return 0;
+
+        // Digits are produced in reverse into a scratch area, then copied into the slot
+        char digits[11];
+        uint8_t count = 0;
+        uint32_t magnitude = value < 0 ? 0UL - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+
+        do
+        {
+            digits[count++] = static_cast<char>('0' + (magnitude % 10));
+            magnitude /= 10;
+        } while (magnitude > 0);
+
+        uint8_t slotLength = count + (value < 0 ? 1 : 0);
+        if (slotLength > slotCapacity())
+            return 0;
+
+        uint8_t* slot = _buffer + _prefixLength;
+
+        if (value < 0)
+            *slot++ = '-';
+
+        while (count > 0)
+            *slot++ = static_cast<uint8_t>(digits[--count]);
+
+        return finishSlot(slotLength);
+    }
+
+    /**
+     * @brief Copy a text value into the slot.
+     * @param text Null-terminated text in RAM; truncated if it does not fit.
+     * @return Total command length including terminator, or 0 if the template is invalid.
+     */
+    size_t format(const char* text)
+    {
+        if (!_valid || !text)
+            return 0;
+
+        uint8_t capacity = slotCapacity();
+        uint8_t* slot = _buffer + _prefixLength;
+        uint8_t slotLength = 0;
+
+        while (text[slotLength] && slotLength < capacity)
+        {
+            slot[slotLength] = static_cast<uint8_t>(text[slotLength]);
+            slotLength++;
+        }
+
+        return finishSlot(slotLength);
+    }
+
+    /// @brief Pointer to the encoded command (valid after `format()`).
+    const uint8_t* data() const { return _buffer; }
+
+    /// @brief Length of the encoded command including terminator (0 before the first `format()`).
+    size_t length() const { return _length; }
+
+    /// @brief true if prefix, suffix and terminator fit in the buffer.
+    bool isValid() const { return _valid; }
+
+protected:
+    NextionPreparedCommandBase(uint8_t* buffer, uint8_t capacity)
+        : _buffer(buffer), _suffix(nullptr), _capacity(capacity),
+          _prefixLength(0), _suffixLength(0), _slotLength(0xFF), _length(0), _valid(false) {}
+
+    /**
+     * @brief Encode the constant parts of the command.
+     * @param prefix Text preceding the slot, stored in PROGMEM (use F() macro).
+     * @param suffix Text following the slot, stored in PROGMEM, or nullptr.
+     */
+    void prepare(const __FlashStringHelper* prefix, const __FlashStringHelper* suffix)
+    {
+        PGM_P prefixText = reinterpret_cast<PGM_P>(prefix);
+        _suffix = reinterpret_cast<PGM_P>(suffix);
+
+        size_t prefixLength = prefixText ? strlen_P(prefixText) : 0;
+        size_t suffixLength = _suffix ? strlen_P(_suffix) : 0;
+
+        _valid = prefixLength + suffixLength + CommandTerminatorLength <= _capacity;
+        if (!_valid)
+            return;
+
+        _prefixLength = static_cast<uint8_t>(prefixLength);
+        _suffixLength = static_cast<uint8_t>(suffixLength);
+
+        if (prefixText)
+            memcpy_P(_buffer, prefixText, _prefixLength);
+    }
+
+private:
+    /// @brief Bytes available for the slot.
+    uint8_t slotCapacity() const
+    {
+        return _capacity - _prefixLength - _suffixLength - CommandTerminatorLength;
+    }
+
+    /// @brief Append suffix and terminator after the slot if its length changed.
+    size_t finishSlot(uint8_t slotLength)
+    {
+        if (slotLength != _slotLength)
+        {
+            uint8_t* tail = _buffer + _prefixLength + slotLength;
+
+            if (_suffixLength > 0)
+                memcpy_P(tail, _suffix, _suffixLength);
+
+            memset(tail + _suffixLength, 0xFF, CommandTerminatorLength);
+
+            _slotLength = slotLength;
+            _length = _prefixLength + slotLength + _suffixLength + CommandTerminatorLength;
+        }
+
+        return _length;
+    }
+
+    uint8_t* _buffer;
+    PGM_P _suffix;
+    uint8_t _capacity;
+    uint8_t _prefixLength;
+    uint8_t _suffixLength;
+    uint8_t _slotLength;
+    uint8_t _length;
+    bool _valid;
+};
+
+/**
+ * @class NextionPreparedCommand
+ * @brief Prepared command with inline storage.
+ *
+ * @tparam Capacity Buffer size in bytes: prefix + largest slot value + suffix + 3
+ *                  (maximum 255). An int32 slot needs at most 11 bytes.
+ */
+template <uint8_t Capacity = 32>
+class NextionPreparedCommand : public NextionPreparedCommandBase {
+public:
+    /**
+     * @brief Construct and encode a command template.
+     * @param prefix Text preceding the slot, stored in PROGMEM (e.g. F("n3.val=")).
+     * @param suffix Text following the slot, stored in PROGMEM (e.g. F("\"")), or nullptr.
+     */
+    explicit NextionPreparedCommand(const __FlashStringHelper* prefix, const __FlashStringHelper* suffix = nullptr)
+        : NextionPreparedCommandBase(_storage, Capacity)
+    {
+        prepare(prefix, suffix);
+    }
+
+private:
+    uint8_t _storage[Capacity];
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionRateLimit.h
+ * @brief Per-component send rate limiting.
+ *
+ * Values that change every few milliseconds (current draw, RPM, ...) would
+ * otherwise be sent on every handler call, crowding out other traffic while
+ * updating faster than anyone can read. A `NextionRateLimit` combines two
+ * independent constraints:
+ * - A minimum interval between consecutive sends.
+ * - A token bucket allowing at most N sends per second, with bursts of up to N.
+ *
+ * The bucket is implemented as a generic cell rate algorithm (a single
+ * "theoretical arrival time"), so the whole limiter takes 7 bytes.
+ *
+ * Each widget holds one (see NextionWidgets.h); a rate-limited widget keeps its
+ * newest value pending and `NextionControl::update()` sends it as soon as the
+ * limiter allows. The limiter can also be used directly to throttle any send.
+ *
+ * Timestamps are stored in 16 bits. After long idle periods a wrapped timestamp
+ * can at worst delay one send by the configured interval.
+ */
+class NextionRateLimit {
+public:
+    NextionRateLimit()
+        : _lastSend(0), _arrival(0), _minInterval(0), _maxPerSecond(0) {}
+
+    /**
+     * @brief Set the minimum time between two sends.
+     * @param intervalMs Minimum interval in milliseconds (0 = no limit).
+     */
+    void setMinInterval(uint16_t intervalMs) { _minInterval = intervalMs; }
+
+    /**
+     * @brief Set the maximum average number of sends per second.
+     *
+     * Up to `perSecond` sends may go out back to back (subject to the minimum
+     * interval) before the bucket is empty; it then refills at `perSecond`.
+     *
+     * @param perSecond Maximum sends per second (0 = no limit).
+     */
+    void setMaxRate(uint8_t perSecond) { _maxPerSecond = perSecond; }
+
+    /// @brief true if either constraint is configured.
+    bool isLimited() const { return _minInterval > 0 || _maxPerSecond > 0; }
+
+    /**
+     * @brief Check whether a send is allowed now without recording it.
+     * @param now Current time in milliseconds.
+     * @return true if a send may go out.
+     */
+    bool allowed(unsigned long now) const
+    {
+        uint16_t now16 = static_cast<uint16_t>(now);
+
+        if (_minInterval > 0 && static_cast<uint16_t>(now16 - _lastSend) < _minInterval)
+            return false;
+
+        if (_maxPerSecond > 0)
+        {
+            // Allowed while the theoretical arrival time is no further ahead than the burst window
+            int16_t ahead = static_cast<int16_t>(_arrival - now16);
+            uint16_t emission = 1000 / _maxPerSecond;
+            int16_t tolerance = static_cast<int16_t>(1000 - emission);
+
+            if (ahead > tolerance && ahead <= static_cast<int16_t>(1000))
+                return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Record a send.
+     * @param now Current time in milliseconds.
+     */
+    void consume(unsigned long now)
+    {
+        uint16_t now16 = static_cast<uint16_t>(now);
+        _lastSend = now16;
+
+        if (_maxPerSecond > 0)
+        {
+            int16_t ahead = static_cast<int16_t>(_arrival - now16);
+
+            // Idle bucket (or a stale, wrapped timestamp) starts again from now
+            if (ahead < 0 || ahead > static_cast<int16_t>(1000))
+                _arrival = now16;
+
+            _arrival += 1000 / _maxPerSecond;
+        }
+    }
+
+    /**
+     * @brief Check and record a send in one call.
+     * @param now Current time in milliseconds.
+     * @return true if the send may go out (and has been recorded).
+     */
+    bool tryConsume(unsigned long now)
+    {
+        if (!allowed(now))
+            return false;
+
+        consume(now);
+        return true;
+    }
+
+private:
+    uint16_t _lastSend;
+    uint16_t _arrival;
+    uint16_t _minInterval;
+    uint8_t _maxPerSecond;
+};
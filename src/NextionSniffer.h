@@ -0,0 +1,332 @@
+#pragma once
+
+#include <Arduino.h>
+#include "NextionHash.h"
+#include "NextionParser.h"
+
+/**
+ * @file NextionSniffer.h
+ * @brief Passive decoder for traffic between a host and a Nextion display.
+ *
+ * For troubleshooting third-party panels, tap both UART lines (host TX and
+ * display TX) into two receive-only ports of a spare MCU or a USB-serial
+ * adapter. `NextionSniffer` assembles frames from both directions with
+ * `NextionParser` and decodes each into a compact `NextionSnifferRecord`
+ * delivered to a callback together with the raw frame. Nothing is ever written
+ * to either port.
+ *
+ * Ports are drained in bulk (`readBytes()` in chunks of `SnifferChunkSize`) and
+ * the per-byte work is a store and a compare. On a host the decoder needs well
+ * under 1% of a core for both directions at 921600 baud (see
+ * extras/host/SnifferThroughput.cpp); on a board, `update()` must also run
+ * before the UART receive buffer fills. Byte sources that are not `Stream`s (DMA
+ * buffers, `read()` on a host tty) can be fed directly with `feed()`.
+ *
+ * @code
+ * void onFrame(const NextionSnifferRecord& record, const uint8_t* frame, size_t length)
+ * {
+ *     Serial.print(record.direction == NextionSnifferRecord::ToDisplay ? F("> ") : F("< "));
+ *     Serial.write(frame, length);
+ *     Serial.println();
+ * }
+ *
+ * NextionSniffer sniffer(&Serial1, &Serial2, onFrame);
+ *
+ * void loop() { sniffer.update(); }
+ * @endcode
+ */
+
+/// Largest frame (terminator included) assembled per direction.
+const size_t SnifferFrameSize = 256;
+
+/// Number of bytes read from a port in one `readBytes()` call.
+const size_t SnifferChunkSize = 64;
+
+/**
+ * @struct NextionSnifferRecord
+ * @brief Decoded summary of one frame (14 bytes on AVR).
+ *
+ * Commands (host to display):
+ * - `type` is `AssignNumber` (`n0.val=5`), `AssignText` (`t0.txt="..."`) or `Command`.
+ * - `target` is the FNV-1a hash of the component path (`n0`, `page1.t0`),
+ *   or of the whole command for `Command`. Compare with `NextionSniffer::hash()`.
+ * - `value` is the assigned number, or the text length.
+ *
+ * Returns (display to host):
+ * - `type` is the return code (0x01, 0x65, 0x66, 0x71, ...).
+ * - `value` is the decoded content: page << 16 | component << 8 | event for
+ *   0x65, the page for 0x66, x << 16 | y for 0x67/0x68, the number for 0x71.
+ * - `target` is the touch event for 0x67/0x68 and the text hash for 0x70.
+ */
+struct NextionSnifferRecord {
+    /// @brief Frame direction.
+    enum Direction : uint8_t {
+        ToDisplay = 0,
+        FromDisplay = 1
+    };
+
+    /// @brief Command types (host to display).
+    enum CommandType : uint8_t {
+        Command = 0,
+        AssignNumber = 1,
+        AssignText = 2
+    };
+
+    /// @brief `micros()` when the frame's terminator was received.
+    unsigned long time;
+
+    /// @brief Decoded value (see above).
+    int32_t value;
+
+    /// @brief Payload length, terminator excluded.
+    uint16_t length;
+
+    /// @brief Folded FNV-1a hash (see above).
+    uint16_t target;
+
+    /// @brief One of `Direction`.
+    uint8_t direction;
+
+    /// @brief `CommandType` for commands, return code for returns.
+    uint8_t type;
+};
+
+/// Called for every decoded frame; `frame` is only valid during the call.
+typedef void (*NextionSnifferCallback)(const NextionSnifferRecord& record, const uint8_t* frame, size_t length);
+
+/**
+ * @class NextionSniffer
+ * @brief Two-direction frame decoder that never transmits.
+ */
+class NextionSniffer {
+public:
+    /**
+     * @brief Construct a sniffer.
+     * @param toDisplay Port receiving the host's TX line, or nullptr if fed with `feed()`.
+     * @param fromDisplay Port receiving the display's TX line, or nullptr if fed with `feed()`.
+     * @param callback Receives every decoded frame.
+     */
+    NextionSniffer(Stream* toDisplay, Stream* fromDisplay, NextionSnifferCallback callback)
+        : _callback(callback), _overflows(0)
+    {
+        _fromDisplay.setReturnFraming(true);
+        _ports[NextionSnifferRecord::ToDisplay] = toDisplay;
+        _ports[NextionSnifferRecord::FromDisplay] = fromDisplay;
+        _frames[NextionSnifferRecord::ToDisplay] = 0;
+        _frames[NextionSnifferRecord::FromDisplay] = 0;
+    }
+
+    /**
+     * @brief Drain both ports and decode every complete frame.
+     *
+     * Reads only the bytes available on entry, alternating between the
+     * directions in chunks so neither can starve the other.
+     */
+    void update()
+    {
+        int pending[2];
+        pending[0] = _ports[0] ? _ports[0]->available() : 0;
+        pending[1] = _ports[1] ? _ports[1]->available() : 0;
+
+        uint8_t chunk[SnifferChunkSize];
+
+        while (pending[0] > 0 || pending[1] > 0)
+        {
+            for (uint8_t direction = 0; direction < 2; direction++)
+            {
+                if (pending[direction] <= 0)
+                    continue;
+
+                size_t count = static_cast<size_t>(pending[direction]) < SnifferChunkSize ? static_cast<size_t>(pending[direction]) : SnifferChunkSize;
+                count = _ports[direction]->readBytes(chunk, count);
+
+                // A port reporting data it cannot deliver is skipped until the next update
+                if (count == 0)
+                {
+                    pending[direction] = 0;
+                    continue;
+                }
+
+                feed(direction, chunk, count);
+                pending[direction] -= static_cast<int>(count);
+            }
+        }
+    }
+
+    /**
+     * @brief Decode bytes received from a non-Stream source.
+     * @param direction `NextionSnifferRecord::ToDisplay` or `FromDisplay`.
+     * @param data Received bytes.
+     * @param length Number of bytes.
+     */
+    void feed(uint8_t direction, const uint8_t* data, size_t length)
+    {
+        direction = direction == NextionSnifferRecord::ToDisplay ? NextionSnifferRecord::ToDisplay : NextionSnifferRecord::FromDisplay;
+
+        NextionParserBase& parser = direction == NextionSnifferRecord::ToDisplay
+            ? static_cast<NextionParserBase&>(_toDisplay)
+            : static_cast<NextionParserBase&>(_fromDisplay);
+
+        for (size_t i = 0; i < length; i++)
+        {
+            NextionParserBase::Result result = parser.feed(data[i]);
+
+            if (result == NextionParserBase::Frame)
+                deliver(direction, parser.frame(), parser.length());
+            else if (result == NextionParserBase::Overflow)
+                _overflows++;
+        }
+    }
+
+    /// @brief Number of frames decoded in a direction.
+    uint32_t frameCount(uint8_t direction) const { return _frames[direction ? 1 : 0]; }
+
+    /// @brief Number of frames discarded because they exceeded `SnifferFrameSize`.
+    uint32_t overflowCount() const { return _overflows; }
+
+    /**
+     * @brief Decode a frame into a record without delivering it.
+     * @param direction `NextionSnifferRecord::ToDisplay` or `FromDisplay`.
+     * @param frame Frame payload, terminator excluded.
+     * @param length Payload length.
+     * @param record Receives the decoded summary (`time` is not set).
+     */
+    static void decode(uint8_t direction, const uint8_t* frame, size_t length, NextionSnifferRecord& record)
+    {
+        record.direction = direction;
+        record.length = static_cast<uint16_t>(length);
+        record.value = 0;
+        record.target = 0;
+        record.type = 0;
+
+        if (direction == NextionSnifferRecord::ToDisplay)
+            decodeCommand(frame, length, record);
+        else if (length > 0)
+            decodeReturn(frame, length, record);
+    }
+
+    /**
+     * @brief Hash a component path or command as the decoder does.
+     * @param text Null-terminated text (e.g. "n0" or "page1.t0").
+     */
+    static uint16_t hash(const char* text)
+    {
+        size_t length;
+        return NextionHash::fold(NextionHash::text(text, length));
+    }
+
+private:
+    void deliver(uint8_t direction, const uint8_t* frame, size_t length)
+    {
+        NextionSnifferRecord record;
+        decode(direction, frame, length, record);
+        record.time = micros();
+        _frames[direction]++;
+
+        if (_callback)
+            _callback(record, frame, length);
+    }
+
+    static void decodeCommand(const uint8_t* frame, size_t length, NextionSnifferRecord& record)
+    {
+        uint32_t pathHash = HashSeed;
+        uint32_t dotHash = HashSeed;
+        bool hasDot = false;
+        size_t i = 0;
+
+        // Component path: everything before the last '.' preceding '='
+        for (; i < length && frame[i] != '='; i++)
+        {
+            if (frame[i] == '.')
+            {
+                dotHash = pathHash;
+                hasDot = true;
+            }
+
+            pathHash = NextionHash::update(pathHash, frame[i]);
+        }
+
+        if (i == length)
+        {
+            record.type = NextionSnifferRecord::Command;
+            record.target = NextionHash::fold(pathHash);
+            return;
+        }
+
+        record.target = NextionHash::fold(hasDot ? dotHash : pathHash);
+        i++;
+
+        if (i < length && frame[i] == '"')
+        {
+            record.type = NextionSnifferRecord::AssignText;
+            record.value = static_cast<int32_t>(length - i - (frame[length - 1] == '"' && length - i > 1 ? 2 : 1));
+            return;
+        }
+
+        // Numeric literal; anything else (expressions, attribute copies) is left at 0
+        record.type = NextionSnifferRecord::AssignNumber;
+        bool negative = i < length && frame[i] == '-';
+        if (negative)
+            i++;
+
+        int32_t value = 0;
+        for (; i < length && frame[i] >= '0' && frame[i] <= '9'; i++)
+            value = value * 10 + (frame[i] - '0');
+
+        record.value = negative ? -value : value;
+    }
+
+    static void decodeReturn(const uint8_t* frame, size_t length, NextionSnifferRecord& record)
+    {
+        record.type = frame[0];
+
+        switch (frame[0])
+        {
+            case 0x65: // Touch event: page, component, event
+                if (length >= 4)
+                    record.value = (static_cast<int32_t>(frame[1]) << 16) | (static_cast<int32_t>(frame[2]) << 8) | frame[3];
+                break;
+
+            case 0x66: // Current page
+                if (length >= 2)
+                    record.value = frame[1];
+                break;
+
+            case 0x67: // Touch coordinates (awake / sleep)
+            case 0x68:
+                if (length >= 6)
+                {
+                    record.value = static_cast<int32_t>((static_cast<uint32_t>((frame[1] << 8) | frame[2]) << 16) | ((frame[3] << 8) | frame[4]));
+                    record.target = frame[5];
+                }
+                break;
+
+            case 0x70: // String return
+            {
+                uint32_t textHash = HashSeed;
+                for (size_t i = 1; i < length; i++)
+                    textHash = NextionHash::update(textHash, frame[i]);
+
+                record.target = NextionHash::fold(textHash);
+                record.value = static_cast<int32_t>(length - 1);
+                break;
+            }
+
+            case 0x71: // Numeric return, little endian
+                if (length >= 5)
+                    record.value = static_cast<int32_t>(static_cast<uint32_t>(frame[1]) | (static_cast<uint32_t>(frame[2]) << 8) |
+                        (static_cast<uint32_t>(frame[3]) << 16) | (static_cast<uint32_t>(frame[4]) << 24));
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    Stream* _ports[2];
+    NextionParser<SnifferFrameSize> _toDisplay;
+    NextionParser<SnifferFrameSize> _fromDisplay;
+    NextionSnifferCallback _callback;
+    uint32_t _frames[2];
+    uint32_t _overflows;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionStringTable.h
+ * @brief Indexed table of flash-resident strings for component names and fixed texts.
+ *
+ * Component names such as "t0" or "btnRelay3" and static labels are typically
+ * repeated across many `sendText`/`setComponentProperty` calls. Declaring them
+ * once in PROGMEM and referring to them by index keeps them out of SRAM on AVR
+ * and lets `BaseDisplayPage` stream them to the display in block writes.
+ *
+ * Example:
+ * @code
+ * const char StrTemp[] PROGMEM = "tTemp";
+ * const char StrIdle[] PROGMEM = "Idle";
+ * const char* const MainPageStrings[] PROGMEM = { StrTemp, StrIdle };
+ *
+ * enum MainPageString : uint8_t { StringTemp, StringIdle };
+ *
+ * const NextionStringTable mainPageTable(MainPageStrings, sizeof(MainPageStrings) / sizeof(MainPageStrings[0]));
+ *
+ * // In the page constructor:
+ * setStringTable(&mainPageTable);
+ *
+ * // Anywhere in the page:
+ * sendText(NextionStringId(StringTemp), NextionStringId(StringIdle));
+ * @endcode
+ */
+
+/**
+ * @struct NextionStringId
+ * @brief Strongly typed index into a `NextionStringTable`.
+ *
+ * A distinct type is used so the table-index overloads of the page helpers do
+ * not collide with the `const char*` overloads when passed a literal 0.
+ */
+struct NextionStringId {
+    explicit constexpr NextionStringId(uint8_t i) : index(i) {}
+
+    /// @brief Zero-based position of the string in the table.
+    uint8_t index;
+};
+
+/**
+ * @class NextionStringTable
+ * @brief Read-only view over a PROGMEM array of PROGMEM string pointers.
+ */
+class NextionStringTable {
+public:
+    /**
+     * @brief Construct a table view.
+     * @param table Array of pointers to strings, with both the array and the strings in PROGMEM.
+     * @param count Number of entries in `table`.
+     */
+    constexpr NextionStringTable(const char* const* table, uint8_t count)
+        : _table(table), _count(count) {}
+
+    /// @brief Number of entries in the table.
+    uint8_t count() const { return _count; }
+
+    /**
+     * @brief Look up an entry.
+     * @param id Index of the entry.
+     * @return PROGMEM pointer to the string, or nullptr if `id` is out of range.
+     */
+    PGM_P get(NextionStringId id) const
+    {
+        if (!_table || id.index >= _count)
+            return nullptr;
+
+#if defined(__AVR__)
+        return reinterpret_cast<PGM_P>(pgm_read_word(&_table[id.index]));
+#elif defined(pgm_read_ptr)
+        return reinterpret_cast<PGM_P>(pgm_read_ptr(&_table[id.index]));
+#else
+        return _table[id.index];
+#endif
+    }
+
+private:
+    const char* const* _table;
+    uint8_t _count;
+};
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionTextEncoder.h
+ * @brief Streaming UTF-8 to display code page transcoder for `sendText`.
+ *
+ * Nextion fonts are generated for a single code page (e.g. ISO-8859-1,
+ * Windows-1252, or a double-byte page such as GB2312), while application
+ * strings are usually UTF-8. When a page has a code page configured with
+ * `BaseDisplayPage::setTextEncoding()`, every RAM text sent through `sendText`
+ * passes through this stage, which in a single pass:
+ * - decodes UTF-8,
+ * - maps each code point through a compact PROGMEM lookup table,
+ * - escapes `"` and `\` so the text cannot break out of the quoted value,
+ * - writes the result to the port in blocks from a small stack buffer.
+ *
+ * No heap is used and the source text is not modified.
+ *
+ * A code page is described by:
+ * - `identityLimit`: code points below this value that are not in the table
+ *   map to themselves (0x80 for ASCII, 0x100 for Latin-1 based pages).
+ * - `table`: PROGMEM array of `NextionCodePoint`, sorted by code point, for
+ *   everything else. Codes above 0xFF are written as two bytes (high, low), so
+ *   double-byte pages such as GB2312 can be supplied by the application.
+ * - `replacement`: byte written for unmappable or malformed input.
+ *
+ * Built-in code pages: `CodePageAscii`, `CodePageLatin1` and `CodePageWindows1252`.
+ */
+
+/**
+ * @struct NextionCodePoint
+ * @brief One entry of a code page lookup table.
+ */
+struct NextionCodePoint {
+    /// @brief Unicode code point (BMP only).
+    uint16_t codepoint;
+
+    /// @brief Display encoding: a single byte, or two bytes (high, low) if above 0xFF.
+    uint16_t code;
+};
+
+/**
+ * @struct NextionCodePage
+ * @brief Description of the code page a Nextion font was generated for.
+ */
+struct NextionCodePage {
+    /// @brief Sorted PROGMEM lookup table, or nullptr.
+    const NextionCodePoint* table;
+
+    /// @brief Number of entries in `table`.
+    uint16_t count;
+
+    /// @brief Code points below this that are not in `table` map to themselves.
+    uint16_t identityLimit;
+
+    /// @brief Byte written for code points that cannot be represented.
+    uint8_t replacement;
+};
+
+/// Size of the stack buffer used when transcoding text to the port.
+const size_t TextEncodeChunkSize = 32;
+
+// Tables are defined once in NextionTextEncoder.cpp so every sketch file shares one flash copy
+
+/// Windows-1252 code points in the 0x80-0x9F range (the rest of 0xA0-0xFF is Latin-1).
+extern const NextionCodePoint Windows1252Table[] PROGMEM;
+
+/// 7-bit ASCII; everything else is replaced with '?'.
+extern const NextionCodePage CodePageAscii;
+
+/// ISO-8859-1: code points up to U+00FF map to themselves.
+extern const NextionCodePage CodePageLatin1;
+
+/// Windows-1252: Latin-1 plus typographic quotes, dashes, euro sign, etc.
+extern const NextionCodePage CodePageWindows1252;
+
+/**
+ * @class NextionTextEncoder
+ * @brief Static helpers for transcoding UTF-8 text to a display code page.
+ */
+class NextionTextEncoder {
+public:
+    /**
+     * @brief Map a code point to its display encoding.
+     * @param codePage Target code page.
+     * @param codepoint Unicode code point.
+     * @return Display code (above 0xFF for double-byte codes), or the replacement byte.
+     */
+    static uint16_t map(const NextionCodePage* codePage, uint32_t codepoint)
+    {
+        if (codepoint < 0x80)
+            return static_cast<uint16_t>(codepoint);
+
+        if (codepoint <= 0xFFFF && codePage->table)
+        {
+            // Binary search of the sorted PROGMEM table
+            uint16_t low = 0;
+            uint16_t high = codePage->count;
+
+            while (low < high)
+            {
+                uint16_t mid = low + (high - low) / 2;
+                uint16_t entry = pgm_read_word(&codePage->table[mid].codepoint);
+
+                if (entry == codepoint)
+                    return pgm_read_word(&codePage->table[mid].code);
+
+                if (entry < codepoint)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+        }
+
+        if (codepoint < codePage->identityLimit)
+            return static_cast<uint16_t>(codepoint);
+
+        return codePage->replacement;
+    }
+
+    /**
+     * @brief Transcode and escape UTF-8 text to a port.
+     * @param port Destination port.
+     * @param text UTF-8 text in RAM.
+     * @param length Number of bytes of `text` to process.
+     * @param codePage Target code page.
+     * @return Number of bytes written.
+     */
+    static size_t write(Print* port, const char* text, size_t length, const NextionCodePage* codePage)
+    {
+        uint8_t chunk[TextEncodeChunkSize];
+        size_t used = 0;
+        size_t written = 0;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(text);
+        const uint8_t* end = p + length;
+
+        while (p < end)
+        {
+            uint32_t codepoint = decode(p, end);
+            uint16_t code = map(codePage, codepoint);
+
+            // Worst case per code point: escape + byte, or two-byte code
+            if (used > TextEncodeChunkSize - 2)
+            {
+                written += port->write(chunk, used);
+                used = 0;
+            }
+
+            if (code > 0xFF)
+            {
+                chunk[used++] = static_cast<uint8_t>(code >> 8);
+                chunk[used++] = static_cast<uint8_t>(code & 0xFF);
+                continue;
+            }
+
+            if (code == '"' || code == '\\')
+                chunk[used++] = '\\';
+
+            chunk[used++] = static_cast<uint8_t>(code);
+        }
+
+        if (used > 0)
+            written += port->write(chunk, used);
+
+        return written;
+    }
+
+private:
+    /// @brief Marker returned by `decode()` for malformed input.
+    static const uint32_t InvalidCodepoint = 0xFFFFFFFFUL;
+
+    /**
+     * @brief Decode one UTF-8 sequence and advance past it.
+     * @param p Current position; advanced past the sequence (at least one byte).
+     * @param end End of input.
+     * @return Code point, or `InvalidCodepoint` if malformed.
+     */
+    static uint32_t decode(const uint8_t*& p, const uint8_t* end)
+    {
+        uint8_t lead = *p++;
+
+        if (lead < 0x80)
+            return lead;
+
+        uint8_t extra;
+        uint32_t codepoint;
+        uint32_t minimum;
+
+        if ((lead & 0xE0) == 0xC0)
+        {
+            extra = 1;
+            codepoint = lead & 0x1F;
+            minimum = 0x80;
+        }
+        else if ((lead & 0xF0) == 0xE0)
+        {
+            extra = 2;
+            codepoint = lead & 0x0F;
+            minimum = 0x800;
+        }
+        else if ((lead & 0xF8) == 0xF0)
+        {
+            extra = 3;
+            codepoint = lead & 0x07;
+            minimum = 0x10000;
+        }
+        else
+        {
+            return InvalidCodepoint;
+        }
+
+        while (extra > 0)
+        {
+            // Stop at a non-continuation byte so it is decoded as the next character
+            if (p >= end || (*p & 0xC0) != 0x80)
+                return InvalidCodepoint;
+
+            codepoint = (codepoint << 6) | (*p++ & 0x3F);
+            extra--;
+        }
+
+        // Overlong forms, UTF-16 surrogates and values beyond Unicode are not characters
+        if (codepoint < minimum || (codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF)
+            return InvalidCodepoint;
+
+        return codepoint;
+    }
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionThread.h
+ * @brief Minimal threading primitives shared by FreeRTOS and host builds.
+ *
+ * `NextionWorker` needs only three things from the platform: a thread, a
+ * signal one thread can wait on with a timeout, and a sleep. They are
+ * implemented on:
+ * - FreeRTOS (ESP32): a task, a binary semaphore and `vTaskDelay()`;
+ * - hosts with `<thread>` (Linux test builds): `std::thread`,
+ *   `std::condition_variable` and `std::this_thread::sleep_for()`.
+ *
+ * `NEXTION_THREADS` is defined when one of them is available, so the same
+ * worker code runs on the target and in Linux tests.
+ */
+
+#if defined(ESP32)
+#define NEXTION_THREADS 1
+#define NEXTION_THREADS_FREERTOS 1
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#elif defined(__has_include)
+#if __has_include(<thread>) && __has_include(<atomic>)
+#define NEXTION_THREADS 1
+#define NEXTION_THREADS_STD 1
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+#endif
+
+#ifdef NEXTION_THREADS
+
+/**
+ * @class NextionSignal
+ * @brief Auto-reset event: `notify()` wakes one `wait()`, or the next one if none is waiting.
+ */
+class NextionSignal {
+public:
+#ifdef NEXTION_THREADS_FREERTOS
+    NextionSignal() : _semaphore(xSemaphoreCreateBinary()) {}
+    ~NextionSignal() { vSemaphoreDelete(_semaphore); }
+
+    /// @brief Wake the waiting thread.
+    void notify() { xSemaphoreGive(_semaphore); }
+
+    /**
+     * @brief Wait for `notify()`.
+     * @param timeout Maximum wait in milliseconds.
+     * @return true if notified, false on timeout.
+     */
+    bool wait(unsigned long timeout)
+    {
+        TickType_t ticks = pdMS_TO_TICKS(timeout);
+        return xSemaphoreTake(_semaphore, ticks > 0 ? ticks : 1) == pdTRUE;
+    }
+
+private:
+    SemaphoreHandle_t _semaphore;
+#else
+    NextionSignal() : _pending(false) {}
+
+    /// @brief Wake the waiting thread.
+    void notify()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending = true;
+        }
+
+        _condition.notify_one();
+    }
+
+    /**
+     * @brief Wait for `notify()`.
+     * @param timeout Maximum wait in milliseconds.
+     * @return true if notified, false on timeout.
+     */
+    bool wait(unsigned long timeout)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        bool notified = _condition.wait_for(lock, std::chrono::milliseconds(timeout), [this] { return _pending; });
+        _pending = false;
+        return notified;
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _pending;
+#endif
+
+    NextionSignal(const NextionSignal&) = delete;
+    NextionSignal& operator=(const NextionSignal&) = delete;
+};
+
+/**
+ * @class NextionThread
+ * @brief A joinable thread running a plain function.
+ */
+class NextionThread {
+public:
+    /// @brief Thread body.
+    typedef void (*Entry)(void* argument);
+
+    NextionThread() : _entry(nullptr), _argument(nullptr), _running(false) {}
+
+    /**
+     * @brief Start the thread.
+     * @param entry Function to run.
+     * @param argument Passed to `entry`.
+     * @param name Task name (FreeRTOS only).
+     * @param stackSize Stack size in bytes (FreeRTOS only).
+     * @param priority Task priority (FreeRTOS only).
+     * @param core Core to pin the task to, or -1 for any (FreeRTOS only).
+     * @return false if already running or the thread could not be created.
+     */
+    bool start(Entry entry, void* argument, const char* name = "nextion", uint32_t stackSize = 4096,
+        uint8_t priority = 2, int8_t core = -1)
+    {
+        if (_running)
+            return false;
+
+        _entry = entry;
+        _argument = argument;
+
+#ifdef NEXTION_THREADS_FREERTOS
+        BaseType_t created = core >= 0
+            ? xTaskCreatePinnedToCore(trampoline, name, stackSize, this, priority, nullptr, core)
+            : xTaskCreate(trampoline, name, stackSize, this, priority, nullptr);
+
+        _running = created == pdPASS;
+#else
+        (void)name;
+        (void)stackSize;
+        (void)priority;
+        (void)core;
+        _thread = std::thread(entry, argument);
+        _running = true;
+#endif
+        return _running;
+    }
+
+    /// @brief Wait for the thread function to return (the caller must have asked it to stop).
+    void join()
+    {
+        if (!_running)
+            return;
+
+#ifdef NEXTION_THREADS_FREERTOS
+        while (!_done.wait(100)) {}
+#else
+        _thread.join();
+#endif
+        _running = false;
+    }
+
+    /// @brief true between `start()` and `join()`.
+    bool isRunning() const { return _running; }
+
+    /**
+     * @brief Sleep the calling thread.
+     * @param milliseconds Sleep time.
+     */
+    static void sleep(unsigned long milliseconds)
+    {
+#ifdef NEXTION_THREADS_FREERTOS
+        TickType_t ticks = pdMS_TO_TICKS(milliseconds);
+        vTaskDelay(ticks > 0 ? ticks : 1);
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+#endif
+    }
+
+private:
+#ifdef NEXTION_THREADS_FREERTOS
+    static void trampoline(void* self)
+    {
+        NextionThread* thread = static_cast<NextionThread*>(self);
+        thread->_entry(thread->_argument);
+        thread->_done.notify();
+        vTaskDelete(nullptr);
+    }
+
+    NextionSignal _done;
+#else
+    std::thread _thread;
+#endif
+
+    Entry _entry;
+    void* _argument;
+    bool _running;
+
+    NextionThread(const NextionThread&) = delete;
+    NextionThread& operator=(const NextionThread&) = delete;
+};
+
+#endif
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @file NextionTouchTimer.h
+ * @brief Long-press, auto-repeat and debounced release for component touches.
+ *
+ * Components with "Send Component ID" report only press (0x65 .. 01) and
+ * release (0x65 .. 00). `NextionTouchTimer` keeps a compact table of registered
+ * components with their timings and press state, and derives the timed events
+ * from the `now` passed to `NextionControl::update()`:
+ * - `Press`: the first press (a press within the debounce time of a release
+ *   continues the previous press instead).
+ * - `Repeat`: after `repeatDelay` while held, then every `repeatInterval`.
+ * - `LongPress`: once, after `longPress` while held.
+ * - `Release`: `debounce` ms after the last release, if no press followed.
+ *
+ * Events are only handler calls: nothing is sent to the display unless the
+ * page's handler does so. Registered components are delivered through
+ * `BaseDisplayPage::handleTouchEvent()` instead of `handleTouch()`:
+ * @code
+ * NextionTouchTimer touchTimer;
+ *
+ * touchTimer.add(1, 3, 0, 500, 100);   // page 1, "+" button: repeat after 500 ms, every 100 ms
+ * touchTimer.add(1, 7, 2000, 0, 0, 30); // page 1, relay button: long press 2 s, 30 ms debounce
+ * nextion.setTouchTimer(&touchTimer);
+ * @endcode
+ *
+ * RAM: `TouchTimerSlots` entries of 24 bytes (AVR).
+ */
+
+/// Number of components with touch timing.
+const uint8_t TouchTimerSlots = 8;
+
+/**
+ * @struct NextionTouchEvent
+ * @brief A press, repeat, long-press or release of a registered component.
+ */
+struct NextionTouchEvent {
+    /// @brief Event types.
+    enum Type : uint8_t {
+        None = 0,
+        Press = 1,
+        Release = 2,
+        Repeat = 3,
+        LongPress = 4
+    };
+
+    /// @brief Page the component belongs to.
+    uint8_t page;
+
+    /// @brief Component ID.
+    uint8_t component;
+
+    /// @brief One of `Type`.
+    uint8_t type;
+
+    /// @brief Number of `Repeat` events of this press, including this one.
+    uint16_t repeats;
+
+    /// @brief Time held since the press (ms, saturates at 65535).
+    uint16_t held;
+};
+
+/**
+ * @class NextionTouchTimer
+ * @brief Fixed table of per-component touch timings and press state.
+ */
+class NextionTouchTimer {
+public:
+    NextionTouchTimer()
+    {
+        for (uint8_t i = 0; i < TouchTimerSlots; i++)
+            _entries[i].flags = 0;
+    }
+
+    /**
+     * @brief Register a component, or change its timings.
+     * @param page Page ID.
+     * @param component Component ID.
+     * @param longPress Hold time (ms) for `LongPress` (0 = none).
+     * @param repeatDelay Hold time (ms) before the first `Repeat` (0 = no repeat).
+     * @param repeatInterval Time (ms) between further repeats (0 = same as `repeatDelay`).
+     * @param debounce Time (ms) a release must last to be reported (0 = immediate).
+     * @return false if the table is full.
+     */
+    bool add(uint8_t page, uint8_t component, uint16_t longPress, uint16_t repeatDelay = 0,
+        uint16_t repeatInterval = 0, uint8_t debounce = 0)
+    {
+        Entry* entry = find(page, component);
+
+        if (!entry)
+        {
+            for (uint8_t i = 0; i < TouchTimerSlots && !entry; i++)
+            {
+                if (!(_entries[i].flags & FlagUsed))
+                    entry = &_entries[i];
+            }
+
+            if (!entry)
+                return false;
+        }
+
+        entry->page = page;
+        entry->component = component;
+        entry->flags = FlagUsed;
+        entry->longPress = longPress;
+        entry->repeatDelay = repeatDelay;
+        entry->repeatInterval = repeatInterval > 0 ? repeatInterval : repeatDelay;
+        entry->debounce = debounce;
+        return true;
+    }
+
+    /// @brief Unregister a component.
+    void remove(uint8_t page, uint8_t component)
+    {
+        Entry* entry = find(page, component);
+        if (entry)
+            entry->flags = 0;
+    }
+
+    /**
+     * @brief Process a touch event from the display.
+     * @param page Page ID.
+     * @param component Component ID.
+     * @param eventType `EventPress` (1) or `EventRelease` (0).
+     * @param now Current time in milliseconds.
+     * @param event Receives the resulting event; `type` is `None` if there is none yet.
+     * @return false if the component is not registered (deliver it as a plain touch).
+     */
+    bool feed(uint8_t page, uint8_t component, uint8_t eventType, unsigned long now, NextionTouchEvent& event)
+    {
+        Entry* entry = find(page, component);
+        if (!entry)
+            return false;
+
+        event.type = NextionTouchEvent::None;
+
+        if (eventType != 0)
+        {
+            // A bounce: the press continues
+            if (entry->flags & FlagReleasing)
+            {
+                entry->flags &= static_cast<uint8_t>(~FlagReleasing);
+                return true;
+            }
+
+            if (entry->flags & FlagDown)
+                return true;
+
+            entry->flags = (entry->flags & FlagUsed) | FlagDown;
+            entry->pressedAt = now;
+            entry->due = now + entry->repeatDelay;
+            entry->repeats = 0;
+            fill(*entry, NextionTouchEvent::Press, now, event);
+            return true;
+        }
+
+        if (!(entry->flags & FlagDown))
+            return true;
+
+        if (entry->debounce == 0)
+        {
+            release(*entry, now, event);
+            return true;
+        }
+
+        entry->flags |= FlagReleasing;
+        entry->releasedAt = now;
+        return true;
+    }
+
+    /**
+     * @brief Report the next due timed event.
+     *
+     * Call repeatedly from the update pass until it returns false.
+     * @param now Current time in milliseconds.
+     * @param event Receives a `Repeat`, `LongPress` or debounced `Release`.
+     * @return true if `event` was filled.
+     */
+    bool poll(unsigned long now, NextionTouchEvent& event)
+    {
+        for (uint8_t i = 0; i < TouchTimerSlots; i++)
+        {
+            Entry& entry = _entries[i];
+
+            if (!(entry.flags & FlagDown))
+                continue;
+
+            // Repeats and long presses pause while a release is being confirmed
+            if (entry.flags & FlagReleasing)
+            {
+                if ((now - entry.releasedAt) >= entry.debounce)
+                {
+                    release(entry, now, event);
+                    return true;
+                }
+
+                continue;
+            }
+
+            if (entry.longPress > 0 && !(entry.flags & FlagLong) && (now - entry.pressedAt) >= entry.longPress)
+            {
+                entry.flags |= FlagLong;
+                fill(entry, NextionTouchEvent::LongPress, now, event);
+                return true;
+            }
+
+            if (entry.repeatDelay > 0 && static_cast<long>(now - entry.due) >= 0)
+            {
+                // Keep the cadence; a late update pass yields one repeat, not a burst
+                entry.due += entry.repeatInterval;
+                if (static_cast<long>(now - entry.due) >= 0)
+                    entry.due = now + entry.repeatInterval;
+
+                if (entry.repeats < 0xFFFF)
+                    entry.repeats++;
+
+                fill(entry, NextionTouchEvent::Repeat, now, event);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// @brief Forget all press state without reporting releases (e.g. on page change).
+    void cancel()
+    {
+        for (uint8_t i = 0; i < TouchTimerSlots; i++)
+            _entries[i].flags &= FlagUsed;
+    }
+
+    /**
+     * @brief Time of the next timed event, for event loops that sleep between updates.
+     * @param due Receives the time in milliseconds.
+     * @return false if no component is held.
+     */
+    bool nextDeadline(unsigned long& due) const
+    {
+        bool found = false;
+
+        for (uint8_t i = 0; i < TouchTimerSlots; i++)
+        {
+            const Entry& entry = _entries[i];
+
+            if (!(entry.flags & FlagDown))
+                continue;
+
+            if (entry.flags & FlagReleasing)
+            {
+                earlier(found, due, entry.releasedAt + entry.debounce);
+                continue;
+            }
+
+            if (entry.longPress > 0 && !(entry.flags & FlagLong))
+                earlier(found, due, entry.pressedAt + entry.longPress);
+
+            if (entry.repeatDelay > 0)
+                earlier(found, due, entry.due);
+        }
+
+        return found;
+    }
+
+    /// @brief true if a registered component is held.
+    bool isHeld(uint8_t page, uint8_t component) const
+    {
+        for (uint8_t i = 0; i < TouchTimerSlots; i++)
+        {
+            const Entry& entry = _entries[i];
+
+            if ((entry.flags & FlagDown) && entry.page == page && entry.component == component)
+                return true;
+        }
+
+        return false;
+    }
+
+private:
+    enum Flags : uint8_t {
+        FlagUsed = 0x01,
+        FlagDown = 0x02,
+        FlagReleasing = 0x04,
+        FlagLong = 0x08
+    };
+
+    struct Entry {
+        unsigned long pressedAt;
+        unsigned long due;
+        unsigned long releasedAt;
+        uint16_t longPress;
+        uint16_t repeatDelay;
+        uint16_t repeatInterval;
+        uint16_t repeats;
+        uint8_t page;
+        uint8_t component;
+        uint8_t flags;
+        uint8_t debounce;
+    };
+
+    Entry* find(uint8_t page, uint8_t component)
+    {
+        for (uint8_t i = 0; i < TouchTimerSlots; i++)
+        {
+            Entry& entry = _entries[i];
+
+            if ((entry.flags & FlagUsed) && entry.page == page && entry.component == component)
+                return &entry;
+        }
+
+        return nullptr;
+    }
+
+    static void fill(const Entry& entry, uint8_t type, unsigned long now, NextionTouchEvent& event)
+    {
+        unsigned long held = now - entry.pressedAt;
+
+        event.page = entry.page;
+        event.component = entry.component;
+        event.type = type;
+        event.repeats = entry.repeats;
+        event.held = static_cast<uint16_t>(held < 0xFFFFUL ? held : 0xFFFFUL);
+    }
+
+    static void earlier(bool& found, unsigned long& due, unsigned long time)
+    {
+        if (!found || static_cast<long>(time - due) < 0)
+            due = time;
+
+        found = true;
+    }
+
+    static void release(Entry& entry, unsigned long now, NextionTouchEvent& event)
+    {
+        fill(entry, NextionTouchEvent::Release, now, event);
+        entry.flags &= FlagUsed;
+    }
+
+    Entry _entries[TouchTimerSlots];
+};
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <Arduino.h>
+#include "NextionHash.h"
+#include "NextionRateLimit.h"
+
+/**
+ * @file NextionWidgets.h
+ * @brief Lightweight widget objects with built-in change detection.
+ *
+ * A widget mirrors one numeric or text attribute of a Nextion component and
+ * remembers what was last sent, so pages can call `set()` as often as they like
+ * without flooding the serial link. Values are never sent from `set()`; changed
+ * widgets are flushed lazily by `NextionControl` after the page's `refresh()`,
+ * and immediately after the page becomes active.
+ *
+ * Features:
+ * - Change detection: unchanged values are never re-sent.
+ * - Deadband: ignore changes smaller than a threshold (numeric widgets).
+ * - Quantization: round values to a step before comparing (numeric widgets).
+ * - Visibility: while a widget is hidden via `BaseDisplayPage::setVisible()`
+ *   its updates are held and flushed in one batch when it is shown again.
+ * - Global scope: widgets marked with `setGlobal()` stay current while their
+ *   page is inactive, so entering the page costs almost nothing on the wire.
+ * - Rate limiting: a minimum update interval and/or a maximum number of
+ *   updates per second. Rapid changes are coalesced and the newest value is
+ *   sent by `NextionControl::update()` as soon as the limit allows.
+ *
+ * Widgets link themselves into their page when constructed and are normally
+ * declared as page members:
+ * @code
+ * class EnginePage : public BaseDisplayPage {
+ * public:
+ *     explicit EnginePage(Stream* s)
+ *         : BaseDisplayPage(s),
+ *           _rpm(this, F("nRpm")),
+ *           _fuel(this, F("jFuel"))
+ *     {
+ *         _rpm.setQuantization(50);
+ *         _rpm.setMinInterval(250);
+ *     }
+ *
+ * protected:
+ *     void refresh(unsigned long now) override
+ *     {
+ *         _rpm.set(readRpm());
+ *         _fuel.set(readFuelPercent());
+ *     }
+ *
+ * private:
+ *     NumberWidget _rpm;
+ *     ProgressWidget _fuel;
+ * };
+ * @endcode
+ *
+ * Footprint on AVR: 14 bytes for picture widgets, 15 for progress bars, 16 for
+ * gauges, 18 for number widgets and 21 for text widgets (no vtable; one pointer links each
+ * widget into its page).
+ */
+
+class BaseDisplayPage;
+
+/**
+ * @class NextionWidget
+ * @brief Common state shared by all widget types.
+ *
+ * Holds the component name, the page link, and the dirty/timing state. The
+ * concrete type is stored in a tag rather than dispatched through virtual
+ * functions to keep each widget free of a vtable pointer.
+ */
+class NextionWidget {
+    friend class BaseDisplayPage;
+
+public:
+    /// @brief true if the widget holds a value that has not yet been sent.
+    bool isDirty() const { return (_flags & FlagDirty) != 0; }
+
+    /**
+     * @brief Force the current value to be sent on the next flush.
+     *
+     * Bypasses change detection and rate limiting. Used when the display is
+     * known to have lost the value (e.g. the page was reloaded).
+     */
+    void invalidate();
+
+    /**
+     * @brief Set the minimum time between two sends of this widget.
+     *
+     * Changes arriving within the interval are coalesced; the newest value is
+     * sent when the interval has elapsed.
+     *
+     * @param intervalMs Minimum interval in milliseconds (0 = no limit).
+     */
+    void setMinInterval(uint16_t intervalMs) { _rateLimit.setMinInterval(intervalMs); }
+
+    /**
+     * @brief Limit this widget to at most `perSecond` sends per second.
+     *
+     * Up to `perSecond` changes may be sent back to back; sustained changes are
+     * then coalesced so the average rate stays within the limit.
+     *
+     * @param perSecond Maximum sends per second (0 = no limit).
+     */
+    void setMaxRate(uint8_t perSecond) { _rateLimit.setMaxRate(perSecond); }
+
+    /// @brief Get the Nextion component name.
+    const __FlashStringHelper* getComponent() const { return _component; }
+
+    /**
+     * @brief true unless the component has been hidden with `BaseDisplayPage::setVisible()`.
+     *
+     * Updates to a hidden widget are held in the widget instead of being sent,
+     * and go out in one batch when the widget is shown again.
+     */
+    bool isVisible() const { return (_flags & FlagHidden) == 0; }
+
+    /**
+     * @brief Mark the component as global (`vscope=global` in the HMI).
+     *
+     * A global widget is kept current while its page is inactive, using
+     * qualified `pageName.component.attr=` writes sent at low priority by
+     * `NextionControl::update()`. Its value survives page changes on the
+     * display, so it is not re-sent when the page is entered.
+     *
+     * @param global true if the component is global.
+     * @note Requires the page to implement `getPageName()`.
+     */
+    void setGlobal(bool global)
+    {
+        if (global)
+            _flags |= FlagGlobal;
+        else
+            _flags &= ~FlagGlobal;
+    }
+
+    /// @brief true if the widget has been marked global with `setGlobal()`.
+    bool isGlobal() const { return (_flags & FlagGlobal) != 0; }
+
+protected:
+    /// @brief Concrete widget type, used by `flush()` in place of virtual dispatch.
+    enum WidgetType : uint8_t {
+        TypeNumber = 0,
+        TypeText = 1,
+        TypeProgress = 2,
+        TypePicture = 3,
+        TypeGauge = 4
+    };
+
+    /// @brief Value is waiting to be sent.
+    static const uint8_t FlagDirty = 0x01;
+
+    /// @brief Send on the next flush regardless of the rate limit.
+    static const uint8_t FlagForce = 0x02;
+
+    /// @brief A value has been set at least once.
+    static const uint8_t FlagHasValue = 0x04;
+
+    /// @brief Component has global scope: keep it current while its page is inactive.
+    static const uint8_t FlagGlobal = 0x08;
+
+    /// @brief Component is hidden on the display; hold updates until shown.
+    static const uint8_t FlagHidden = 0x10;
+
+    /// @brief Bit position of the widget type within `_flags`.
+    static const uint8_t TypeShift = 5;
+
+    /**
+     * @brief Construct a widget and link it into its page.
+     * @param page Owning page. Must outlive the widget (normally a member of it).
+     * @param component Component name stored in PROGMEM (use F() macro).
+     * @param type Concrete widget type.
+     */
+    NextionWidget(BaseDisplayPage* page, const __FlashStringHelper* component, WidgetType type);
+
+    /// @brief Record that a new value is waiting to be sent.
+    void markChanged() { _flags |= FlagDirty | FlagHasValue; }
+
+    WidgetType getType() const { return static_cast<WidgetType>(_flags >> TypeShift); }
+
+    uint8_t _flags;
+
+private:
+    /**
+     * @brief Send the pending value if the page is active and the rate limit allows it.
+     * @param page Owning page.
+     * @param now Current time in milliseconds.
+     * @return true if a command was sent.
+     */
+    bool flush(BaseDisplayPage* page, unsigned long now);
+
+    NextionWidget* _next;
+    const __FlashStringHelper* _component;
+    NextionRateLimit _rateLimit;
+};
+
+/**
+ * @class NextionNumericWidget
+ * @brief Shared implementation for widgets holding a single numeric attribute.
+ *
+ * @tparam T     Storage type of the value.
+ * @tparam Max   Largest value accepted by the component; larger values are clamped.
+ */
+template <typename T, int32_t Max>
+class NextionNumericWidget : public NextionWidget {
+public:
+    /**
+     * @brief Ignore changes smaller than `deadband` relative to the held value.
+     * @param deadband Minimum change that will be sent (0 = any change, max 32767).
+     */
+    void setDeadband(uint16_t deadband)
+    {
+        _step = deadband & StepMask;
+    }
+
+    /**
+     * @brief Round values to the nearest multiple of `step` before comparing.
+     * @param step Quantization step (0 or 1 = no quantization, max 32767).
+     */
+    void setQuantization(uint16_t step)
+    {
+        _step = (step & StepMask) | StepQuantize;
+    }
+
+    /**
+     * @brief Update the value; it is sent on the next flush if it changed.
+     * @param value New value.
+     */
+    void set(int32_t value)
+    {
+        if (value > Max)
+            value = Max;
+
+        int32_t step = _step & StepMask;
+        bool quantize = (_step & StepQuantize) != 0;
+
+        // Rounding and deltas near the int32_t limits are done in 64 bits
+        if (quantize && step > 1)
+        {
+            int32_t half = step / 2;
+            int64_t rounded = ((static_cast<int64_t>(value) + (value >= 0 ? half : -half)) / step) * step;
+
+            // Round towards zero instead of past the range
+            if (rounded > Max)
+                rounded -= step;
+            else if (rounded < INT32_MIN)
+                rounded += step;
+
+            value = static_cast<int32_t>(rounded);
+        }
+
+        if (_flags & FlagHasValue)
+        {
+            int64_t delta = static_cast<int64_t>(value) - static_cast<int32_t>(_value);
+
+            if (delta == 0)
+                return;
+
+            if (!quantize && (delta < 0 ? -delta : delta) < step)
+                return;
+        }
+
+        _value = (T)value;
+        markChanged();
+    }
+
+    /// @brief Get the held value (the last value sent, or the one waiting to be sent).
+    T value() const { return _value; }
+
+protected:
+    NextionNumericWidget(BaseDisplayPage* page, const __FlashStringHelper* component, WidgetType type)
+        : NextionWidget(page, component, type), _value(0), _step(0) {}
+
+private:
+    friend class NextionWidget;
+
+    /// @brief Bit in `_step` marking it as a quantization step rather than a deadband.
+    static const uint16_t StepQuantize = 0x8000;
+
+    /// @brief Bits of `_step` holding the step size.
+    static const uint16_t StepMask = 0x7FFF;
+
+    T _value;
+    uint16_t _step;
+};
+
+/**
+ * @class NumberWidget
+ * @brief Signed 32-bit `val` attribute of a number, slider or variable component.
+ */
+class NumberWidget : public NextionNumericWidget<int32_t, INT32_MAX> {
+public:
+    NumberWidget(BaseDisplayPage* page, const __FlashStringHelper* component)
+        : NextionNumericWidget(page, component, TypeNumber) {}
+};
+
+/**
+ * @class ProgressWidget
+ * @brief `val` attribute of a progress bar (0-100).
+ */
+class ProgressWidget : public NextionNumericWidget<uint8_t, 100> {
+public:
+    ProgressWidget(BaseDisplayPage* page, const __FlashStringHelper* component)
+        : NextionNumericWidget(page, component, TypeProgress) {}
+
+    /// @brief Update the value; negative values are clamped to 0.
+    void set(int32_t value) { NextionNumericWidget::set(value < 0 ? 0 : value); }
+};
+
+/**
+ * @class GaugeWidget
+ * @brief `val` attribute of a gauge component (0-360 degrees).
+ */
+class GaugeWidget : public NextionNumericWidget<uint16_t, 360> {
+public:
+    GaugeWidget(BaseDisplayPage* page, const __FlashStringHelper* component)
+        : NextionNumericWidget(page, component, TypeGauge) {}
+
+    /// @brief Update the angle; negative values are clamped to 0.
+    void set(int32_t value) { NextionNumericWidget::set(value < 0 ? 0 : value); }
+};
+
+/**
+ * @class PictureWidget
+ * @brief `pic` attribute of a picture or button component.
+ */
+class PictureWidget : public NextionWidget {
+    friend class NextionWidget;
+
+public:
+    PictureWidget(BaseDisplayPage* page, const __FlashStringHelper* component)
+        : NextionWidget(page, component, TypePicture), _picture(0) {}
+
+    /**
+     * @brief Update the picture ID; it is sent on the next flush if it changed.
+     * @param pictureId Picture resource ID from Nextion Editor.
+     */
+    void set(uint16_t pictureId)
+    {
+        if ((_flags & FlagHasValue) && pictureId == _picture)
+            return;
+
+        _picture = pictureId;
+        markChanged();
+    }
+
+    /// @brief Get the held picture ID.
+    uint16_t value() const { return _picture; }
+
+private:
+    uint16_t _picture;
+};
+
+/**
+ * @class TextWidget
+ * @brief `txt` attribute of a text or button component.
+ *
+ * The widget does not copy the text: it keeps a pointer to a caller-owned
+ * buffer, which must remain valid until the text has been sent. Typically the
+ * buffer is a member of the page. Change detection uses a `NextionTextHash` of
+ * the last text sent, so calling `set()` with an unchanged buffer costs nothing
+ * on the wire.
+ */
+class TextWidget : public NextionWidget {
+    friend class NextionWidget;
+
+public:
+    TextWidget(BaseDisplayPage* page, const __FlashStringHelper* component)
+        : NextionWidget(page, component, TypeText), _text(nullptr) {}
+
+    /**
+     * @brief Set the text to show; it is sent on the next flush if its hash changed.
+     * @param text Null-terminated text in RAM (nullptr is ignored).
+     */
+    void set(const char* text)
+    {
+        if (!text)
+            return;
+
+        _text = text;
+        markChanged();
+    }
+
+    /// @brief Get the held text pointer.
+    const char* value() const { return _text; }
+
+private:
+    const char* _text;
+    NextionTextHash _lastSent;
+};
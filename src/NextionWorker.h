@@ -0,0 +1,400 @@
+#pragma once
+
+#include <Arduino.h>
+#include "NextionControl.h"
+#include "NextionParser.h"
+#include "NextionThread.h"
+
+/**
+ * @file NextionWorker.h
+ * @brief Optional worker thread that owns the display's `Stream`.
+ *
+ * Normally `NextionControl::update()` reads and writes the port itself, so
+ * display latency depends on everything else in the application loop. With a
+ * `NextionWorker`, a dedicated thread (a FreeRTOS task, or `std::thread` on a
+ * host build) owns the port:
+ * - it reads received bytes in chunks, assembles frames with `NextionParser`
+ *   and queues each complete frame;
+ * - it sends outbound bytes as soon as a command is complete, in chunks.
+ *
+ * The controller and its pages talk to `port()`, a `Stream` backed by two
+ * single-producer/single-consumer rings, so page handlers keep running on the
+ * application thread that calls `update()`; they only ever see complete
+ * frames. Writes block only while the outbound ring is full.
+ *
+ * @code
+ * NextionWorker worker(&Serial2);
+ * NextionControl nextion(&worker.port(), pages, pageCount);
+ *
+ * void setup()
+ * {
+ *     Serial2.begin(115200);
+ *     worker.start();
+ *     nextion.begin();
+ * }
+ *
+ * void loop() { nextion.update(millis()); }
+ * @endcode
+ *
+ * The worker wakes when a command is complete and otherwise polls the port
+ * every `WorkerIdleWait` ms, since `Stream` has no readiness notification.
+ * Only one application thread may use `port()`; other tasks post through a
+ * `NextionCommandQueue`.
+ */
+
+#ifdef NEXTION_THREADS
+
+#include <atomic>
+
+/// Size (power of two) of the ring of frames received from the display.
+const size_t WorkerRxBufferSize = 1024;
+
+/// Size (power of two) of the ring of bytes to send to the display.
+const size_t WorkerTxBufferSize = 1024;
+
+/// Longest time (ms) the worker sleeps between polls of the port.
+const unsigned long WorkerIdleWait = 1;
+
+/// Number of bytes the worker moves between the port and a ring per call.
+const size_t WorkerChunkSize = 64;
+
+/**
+ * @class NextionByteRing
+ * @brief Lock-free single-producer/single-consumer byte ring.
+ *
+ * The producer appends bytes privately and makes them visible with `publish()`,
+ * so the consumer can be given whole frames or commands at once.
+ *
+ * @tparam Capacity Size in bytes (power of two).
+ */
+template <size_t Capacity>
+class NextionByteRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    NextionByteRing() : _pending(0), _readPosition(0), _head(0), _tail(0) {}
+
+    /// @brief Producer: bytes that can still be appended.
+    size_t writable() const { return Capacity - (_pending - _tail.load(std::memory_order_acquire)); }
+
+    /// @brief Producer: append bytes (the caller checks `writable()`).
+    void put(const uint8_t* data, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+            _buffer[(_pending + i) & (Capacity - 1)] = data[i];
+
+        _pending += static_cast<uint32_t>(length);
+    }
+
+    /// @brief Producer: append one byte (the caller checks `writable()`).
+    void put(uint8_t value) { _buffer[_pending++ & (Capacity - 1)] = value; }
+
+    /// @brief Producer: make the appended bytes visible to the consumer.
+    void publish() { _head.store(_pending, std::memory_order_release); }
+
+    /// @brief Producer: number of bytes appended but not published.
+    size_t unpublished() const { return _pending - _head.load(std::memory_order_relaxed); }
+
+    /// @brief Consumer: bytes available to read.
+    size_t readable() const { return _head.load(std::memory_order_acquire) - _readPosition; }
+
+    /// @brief Consumer: next byte without removing it (the caller checks `readable()`).
+    uint8_t front() const { return _buffer[_readPosition & (Capacity - 1)]; }
+
+    /**
+     * @brief Consumer: longest run of readable bytes that is contiguous in memory.
+     * @param data Receives a pointer to the first byte.
+     * @return Number of bytes at `data`.
+     */
+    size_t contiguous(const uint8_t*& data) const
+    {
+        size_t available = readable();
+        size_t offset = _readPosition & (Capacity - 1);
+        data = _buffer + offset;
+        return available < Capacity - offset ? available : Capacity - offset;
+    }
+
+    /// @brief Consumer: remove bytes that have been read.
+    void consume(size_t length)
+    {
+        _readPosition += static_cast<uint32_t>(length);
+        _tail.store(_readPosition, std::memory_order_release);
+    }
+
+private:
+    uint8_t _buffer[Capacity];
+    uint32_t _pending;
+    uint32_t _readPosition;
+    std::atomic<uint32_t> _head;
+    std::atomic<uint32_t> _tail;
+};
+
+class NextionWorker;
+
+/**
+ * @class NextionWorkerPort
+ * @brief `Stream` given to `NextionControl` when a worker owns the real port.
+ *
+ * Reads return complete received frames; writes are queued and handed to the
+ * worker at each command terminator.
+ */
+class NextionWorkerPort : public Stream {
+public:
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    void flush() override;
+    using Print::write;
+
+private:
+    friend class NextionWorker;
+    explicit NextionWorkerPort(NextionWorker* worker) : _worker(worker), _terminatorCount(0) {}
+
+    NextionWorker* _worker;
+    uint8_t _terminatorCount;
+};
+
+/**
+ * @class NextionWorker
+ * @brief Thread that frames received data and sends queued commands.
+ */
+class NextionWorker {
+    static_assert(WorkerRxBufferSize >= 2 * (SerialBufferSize + WorkerChunkSize), "Receive ring too small for a frame and a chunk");
+
+public:
+    /**
+     * @brief Construct a worker for a port.
+     * @param serial Port connected to the display; only the worker touches it once started.
+     */
+    explicit NextionWorker(Stream* serial)
+        : _serial(serial), _port(this), _running(false), _frames(0), _droppedFrames(0), _lastByteTime(0)
+    {
+        _parser.setReturnFraming(true);
+    }
+
+    ~NextionWorker() { stop(); }
+
+    /// @brief Stream to pass to `NextionControl`.
+    Stream& port() { return _port; }
+
+    /**
+     * @brief Start the worker thread.
+     * @param priority Task priority (FreeRTOS only).
+     * @param core Core to pin the task to, or -1 for any (FreeRTOS only).
+     * @return false if already running or the thread could not be created.
+     */
+    bool start(uint8_t priority = 2, int8_t core = -1)
+    {
+        if (_thread.isRunning())
+            return false;
+
+        _running.store(true);
+
+        if (_thread.start(run, this, "nextion", 4096, priority, core))
+            return true;
+
+        _running.store(false);
+        return false;
+    }
+
+    /// @brief Stop the worker thread after it has sent the pending commands.
+    void stop()
+    {
+        if (!_thread.isRunning())
+            return;
+
+        _running.store(false);
+        _wake.notify();
+        _thread.join();
+    }
+
+    /// @brief Number of frames received.
+    uint32_t frameCount() const { return _frames.load(std::memory_order_relaxed); }
+
+    /// @brief Number of frames dropped because they did not fit the receive ring.
+    uint32_t droppedFrames() const { return _droppedFrames.load(std::memory_order_relaxed); }
+
+private:
+    friend class NextionWorkerPort;
+
+    static void run(void* self)
+    {
+        static_cast<NextionWorker*>(self)->loop();
+    }
+
+    void loop()
+    {
+        while (_running.load(std::memory_order_relaxed))
+        {
+            bool busy = transmit();
+            busy = receive() || busy;
+
+            if (!busy)
+                _wake.wait(WorkerIdleWait);
+        }
+
+        // Send what the application queued before stopping
+        while (transmit()) {}
+    }
+
+    /// @brief Send published outbound bytes; true if anything was sent.
+    bool transmit()
+    {
+        const uint8_t* data;
+        size_t length = _tx.contiguous(data);
+
+        if (length == 0)
+            return false;
+
+        if (length > WorkerChunkSize)
+            length = WorkerChunkSize;
+
+        size_t written = _serial->write(data, length);
+        _tx.consume(written);
+        return written > 0;
+    }
+
+    /// @brief Frame received bytes; true if anything was read.
+    bool receive()
+    {
+        // Leave data in the port's buffer until the application catches up
+        if (_rx.writable() < SerialBufferSize + WorkerChunkSize)
+            return false;
+
+        int available = _serial->available();
+
+        if (available <= 0)
+        {
+            expire();
+            return false;
+        }
+
+        uint8_t chunk[WorkerChunkSize];
+        size_t count = _serial->readBytes(chunk, static_cast<size_t>(available) < WorkerChunkSize ? static_cast<size_t>(available) : WorkerChunkSize);
+        _lastByteTime = millis();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (_parser.feed(chunk[i]) == NextionParserBase::Frame)
+                deliver();
+        }
+
+        return count > 0;
+    }
+
+    /// @brief Salvage or drop a stalled partial frame.
+    void expire()
+    {
+        if (_parser.isReceiving() && (millis() - _lastByteTime) > SerialTimeout &&
+            _parser.expire() == NextionParserBase::Frame)
+        {
+            deliver();
+        }
+    }
+
+    /// @brief Queue the parser's frame, with its terminator, for the application.
+    void deliver()
+    {
+        static const uint8_t terminator[3] = { 0xFF, 0xFF, 0xFF };
+        size_t length = _parser.length();
+
+        if (_rx.writable() < length + sizeof(terminator))
+        {
+            _droppedFrames.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        _rx.put(_parser.frame(), length);
+        _rx.put(terminator, sizeof(terminator));
+        _rx.publish();
+        _frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// @brief Application side: append an outbound byte, waiting while the ring is full.
+    void queue(uint8_t value)
+    {
+        while (_tx.writable() == 0)
+        {
+            // Hand over what is queued so the worker can make room
+            _tx.publish();
+            _wake.notify();
+            NextionThread::sleep(WorkerIdleWait);
+        }
+
+        _tx.put(value);
+    }
+
+    /// @brief Application side: hand queued bytes to the worker.
+    void commit()
+    {
+        if (_tx.unpublished() == 0)
+            return;
+
+        _tx.publish();
+        _wake.notify();
+    }
+
+    Stream* _serial;
+    NextionWorkerPort _port;
+    NextionParser<SerialBufferSize> _parser;
+    NextionByteRing<WorkerRxBufferSize> _rx;
+    NextionByteRing<WorkerTxBufferSize> _tx;
+    NextionThread _thread;
+    NextionSignal _wake;
+    std::atomic<bool> _running;
+    std::atomic<uint32_t> _frames;
+    std::atomic<uint32_t> _droppedFrames;
+    unsigned long _lastByteTime;
+};
+
+inline int NextionWorkerPort::available()
+{
+    return static_cast<int>(_worker->_rx.readable());
+}
+
+inline int NextionWorkerPort::read()
+{
+    if (_worker->_rx.readable() == 0)
+        return -1;
+
+    uint8_t value = _worker->_rx.front();
+    _worker->_rx.consume(1);
+    return value;
+}
+
+inline int NextionWorkerPort::peek()
+{
+    return _worker->_rx.readable() > 0 ? _worker->_rx.front() : -1;
+}
+
+inline size_t NextionWorkerPort::write(uint8_t value)
+{
+    _worker->queue(value);
+
+    // A complete command goes to the worker straight away
+    _terminatorCount = value == 0xFF ? _terminatorCount + 1 : 0;
+    if (_terminatorCount >= 3)
+    {
+        _terminatorCount = 0;
+        _worker->commit();
+    }
+
+    return 1;
+}
+
+inline size_t NextionWorkerPort::write(const uint8_t* buffer, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        write(buffer[i]);
+
+    return size;
+}
+
+inline void NextionWorkerPort::flush()
+{
+    _worker->commit();
+}
+
+#endif